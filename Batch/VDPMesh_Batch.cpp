@@ -0,0 +1,427 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+/*
+ * Extraction de niveaux de détail sans interface (ni Qt ni OpenGL, VDPMESH_HEADLESS) :
+ *
+ *   VDPMesh_Batch [options] maillage1 [maillage2 ...]
+ *     -o dossier          dossier de sortie (défaut : .)
+ *     -p pourcentage      sommets conservés par la construction (défaut : 10)
+ *     -box x0 y0 z0 x1 y1 z1
+ *                         boîte d'intérêt (répétable)
+ *     -view ex ey ez cx cy cz fovy hauteur [tolérance]
+ *                         point de vue : oeil, point visé, angle vertical (degrés),
+ *                         hauteur de l'image (pixels), tolérance (pixels, défaut 1)
+ *     -regions fichier    régions, une par ligne : "box ..." ou "view ..." (# : commentaire)
+ *     -graded             critère gradué autour des boîtes
+ *     -j threads          taille de la réserve de threads (défaut : nombre de coeurs)
+ *     -v                  messages de la bibliothèque
+ *
+ * La hiérarchie de chaque maillage est construite une seule fois (ou relue depuis
+ * dossier/nom.vdpm), puis chaque région est extraite à partir de ce cache dans sa
+ * propre carte : les maillages, puis les couples (maillage, région), sont traités
+ * en parallèle. Résultat : dossier/nom_<région>.off
+ */
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+
+#include "Topology/generic/parameters.h"
+#include "Topology/generic/dartmarker.h"
+#include "Topology/map/embeddedMap2.h"
+
+#include "Algo/Import/import.h"
+#include "Algo/Export/export.h"
+#include "Algo/Geometry/boundingbox.h"
+
+#include "VDPMesh.h"
+
+using namespace CGoGN ;
+using namespace CGoGN::Algo::Surface::VDPMesh ;
+
+/*
+ * Région à extraire : boîte d'intérêt ou point de vue
+ */
+struct LODRegion
+{
+	enum Kind { BOX, VIEW } ;
+
+	Kind kind ;
+	VEC3 a, b ;             //Boîte : coins min et max ; vue : oeil et point visé
+	float fovy ;            //Degrés
+	unsigned int height ;   //Pixels
+	float tolerance ;
+
+	LODRegion() : kind(BOX), fovy(45.0f), height(1080), tolerance(1.0f) {}
+
+	//Lecture de "box ..." ou "view ..." ; faux si la ligne est mal formée
+	bool parse(std::istream& in)
+	{
+		std::string word ;
+		if(!(in >> word))
+			return false ;
+		if(word == "box")
+		{
+			kind = BOX ;
+			if(!(in >> a[0] >> a[1] >> a[2] >> b[0] >> b[1] >> b[2]))
+				return false ;
+			for(unsigned int k = 0 ; k < 3 ; ++k)
+			{
+				if(a[k] > b[k])
+					std::swap(a[k], b[k]) ;
+			}
+			return true ;
+		}
+		if(word == "view")
+		{
+			kind = VIEW ;
+			if(!(in >> a[0] >> a[1] >> a[2] >> b[0] >> b[1] >> b[2] >> fovy >> height))
+				return false ;
+			if(!(in >> tolerance))
+				tolerance = 1.0f ;
+			return true ;
+		}
+		return false ;
+	}
+
+	/*
+	 * Matrices OpenGL (stockage par colonnes) de la caméra, plans proche et lointain
+	 * tirés de la taille du modèle
+	 */
+	ViewCriterion view(float modelSize) const
+	{
+		VEC3 f = b - a ;
+		float dist = f.norm() ;
+		f.normalize() ;
+		VEC3 up = std::fabs(f[1]) < 0.99f ? VEC3(0.0f, 1.0f, 0.0f) : VEC3(0.0f, 0.0f, 1.0f) ;
+		VEC3 s = f ^ up ;
+		s.normalize() ;
+		VEC3 u = s ^ f ;
+
+		float modelview[16] = {
+			s[0], u[0], -f[0], 0.0f,
+			s[1], u[1], -f[1], 0.0f,
+			s[2], u[2], -f[2], 0.0f,
+			-(s * a), -(u * a), f * a, 1.0f
+		} ;
+		float zNear = std::max(1e-3f * modelSize, 1e-2f * dist) ;
+		float zFar = dist + 2.0f * modelSize ;
+		float t = 1.0f / std::tan(fovy * HALF_PI / 180.0f) ;
+		float projection[16] = {
+			t, 0.0f, 0.0f, 0.0f,
+			0.0f, t, 0.0f, 0.0f,
+			0.0f, 0.0f, (zFar + zNear) / (zNear - zFar), -1.0f,
+			0.0f, 0.0f, 2.0f * zFar * zNear / (zNear - zFar), 0.0f
+		} ;
+
+		ViewCriterion v ;
+		v.setFromMatrices(modelview, projection, height) ;
+		v.setTolerance(tolerance) ;
+		return v ;
+	}
+} ;
+
+struct BatchOptions
+{
+	std::string outDir ;
+	unsigned int percent ;
+	bool graded ;
+	int nbThreads ;
+	bool verbose ;
+
+	BatchOptions() : outDir("."), percent(10), graded(false), nbThreads(0), verbose(false) {}
+} ;
+
+/*
+ * Maillage d'entrée chargé dans sa propre carte
+ */
+struct LoadedMesh
+{
+	PFP::MAP map ;
+	VertexAttribute<VEC3> position ;
+	std::string positionName ;
+	Geom::BoundingBox<VEC3> bb ;
+
+	bool load(const std::string& filename)
+	{
+		std::vector<std::string> attrNames ;
+		if(!Algo::Surface::Import::importMesh<PFP>(map, filename.c_str(), attrNames))
+			return false ;
+		positionName = attrNames[0] ;
+		position = map.getAttribute<VEC3, VERTEX>(positionName) ;
+		bb = Algo::Geometry::computeBoundingBox<PFP>(map, position) ;
+		return true ;
+	}
+} ;
+
+static void report(const std::string& message)
+{
+	#pragma omp critical(vdpm_batch_log)
+	std::cout << message << std::endl ;
+}
+
+static std::string baseName(const std::string& filename)
+{
+	size_t slash = filename.find_last_of("/\\") ;
+	std::string name = slash == std::string::npos ? filename : filename.substr(slash + 1) ;
+	size_t dot = name.rfind('.') ;
+	return dot == std::string::npos ? name : name.substr(0, dot) ;
+}
+
+/*
+ * Construction (ou relecture) de la hiérarchie d'un maillage, enregistrée dans le cache
+ */
+struct BuildTask
+{
+	std::string input ;
+	std::string cacheFile ;
+	unsigned long long key ;
+	bool ok ;
+
+	void run(const BatchOptions& options)
+	{
+		ok = false ;
+		double start = wallClock() ;
+		LoadedMesh mesh ;
+		if(!mesh.load(input))
+		{
+			report("could not import " + input) ;
+			return ;
+		}
+		DartMarker inactive(mesh.map) ;
+		VDProgressiveMesh<PFP> pmesh(mesh.map, inactive, mesh.position, mesh.bb) ;
+		pmesh.setBuildMode(BUILD_SERIAL) ;
+		key = pmesh.hierarchyKey(hashFile(input), options.percent) ;
+		if(!pmesh.loadHierarchy(cacheFile, key))
+		{
+			pmesh.createPM(options.percent) ;
+			if(!pmesh.saveHierarchy(cacheFile, key))
+			{
+				report("could not write hierarchy cache " + cacheFile) ;
+				return ;
+			}
+		}
+		ok = true ;
+		std::ostringstream s ;
+		s << input << " : " << pmesh.getNodes().size() << " noeuds (" << wallClock() - start << " s)" ;
+		report(s.str()) ;
+	}
+} ;
+
+/*
+ * Extraction d'une région à partir de la hiérarchie en cache
+ */
+struct ExtractTask
+{
+	const BuildTask* build ;
+	const LODRegion* region ;
+	std::string output ;
+	bool ok ;
+
+	void run(const BatchOptions& options)
+	{
+		ok = false ;
+		if(!build->ok)
+			return ;
+		double start = wallClock() ;
+		LoadedMesh mesh ;
+		if(!mesh.load(build->input))
+			return ;
+		DartMarker inactive(mesh.map) ;
+		VDProgressiveMesh<PFP> pmesh(mesh.map, inactive, mesh.position, mesh.bb) ;
+		if(!pmesh.loadHierarchy(build->cacheFile, build->key))
+		{
+			report("could not reload hierarchy cache " + build->cacheFile) ;
+			return ;
+		}
+
+		if(region->kind == LODRegion::VIEW)
+		{
+			pmesh.setRefinementCriterion(CRITERION_VIEW) ;
+			pmesh.setView(region->view(mesh.bb.maxSize())) ;
+		}
+		else
+		{
+			pmesh.getInterestBox()->setPosMin(region->a) ;
+			pmesh.getInterestBox()->setPosMax(region->b) ;
+			if(options.graded)
+			{
+				pmesh.setGradedFalloff(LinearFalloff(0.0f, 0.02f, mesh.bb.maxSize())) ;
+				pmesh.setRefinementCriterion(CRITERION_GRADED) ;
+			}
+		}
+		pmesh.updateRefinement() ;
+
+		//L'attribut de position a été remplacé avec la carte rechargée
+		VertexAttribute<VEC3> position = mesh.map.getAttribute<VEC3, VERTEX>(mesh.positionName) ;
+		SelectorUnmarked active(inactive) ;
+		if(!Algo::Surface::Export::exportOFF<PFP>(mesh.map, position, output.c_str(), active))
+		{
+			report("could not write " + output) ;
+			return ;
+		}
+		ok = true ;
+		std::ostringstream s ;
+		s << output << " : " << pmesh.getFront().size() << " sommets (" << wallClock() - start << " s)" ;
+		report(s.str()) ;
+	}
+} ;
+
+/*
+ * Réserve de threads : les tâches sont distribuées une à une aux threads libres
+ * (ordonnancement dynamique OpenMP). Les constructions internes ne se parallélisent
+ * pas en plus (OpenMP non imbriqué).
+ */
+template <typename Task>
+void runTasks(std::vector<Task>& tasks, const BatchOptions& options)
+{
+	int nbTasks = int(tasks.size()) ;
+#ifdef _OPENMP
+	int nbThreads = options.nbThreads > 0 ? options.nbThreads : omp_get_max_threads() ;
+	#pragma omp parallel for schedule(dynamic, 1) num_threads(nbThreads)
+#endif
+	for(int i = 0 ; i < nbTasks ; ++i)
+		tasks[i].run(options) ;
+}
+
+static int usage()
+{
+	std::cerr << "usage : VDPMesh_Batch [-o dossier] [-p pourcentage] [-box x0 y0 z0 x1 y1 z1]..."
+	          << " [-view ex ey ez cx cy cz fovy hauteur [tolérance]]... [-regions fichier]"
+	          << " [-graded] [-j threads] [-v] maillage..." << std::endl ;
+	return 2 ;
+}
+
+int main(int argc, char** argv)
+{
+	BatchOptions options ;
+	std::vector<std::string> inputs ;
+	std::vector<LODRegion> regions ;
+
+	for(int i = 1 ; i < argc ; ++i)
+	{
+		std::string arg(argv[i]) ;
+		if(arg == "-o" && i + 1 < argc)
+			options.outDir = argv[++i] ;
+		else if(arg == "-p" && i + 1 < argc)
+			options.percent = atoi(argv[++i]) ;
+		else if(arg == "-j" && i + 1 < argc)
+			options.nbThreads = atoi(argv[++i]) ;
+		else if(arg == "-graded")
+			options.graded = true ;
+		else if(arg == "-v")
+			options.verbose = true ;
+		else if(arg == "-box" || arg == "-view")
+		{
+			//Les valeurs suivantes jusqu'à la prochaine option
+			std::ostringstream line ;
+			line << arg.substr(1) ;
+			while(i + 1 < argc && (argv[i + 1][0] != '-' || isdigit(argv[i + 1][1]) || argv[i + 1][1] == '.'))
+				line << " " << argv[++i] ;
+			std::istringstream in(line.str()) ;
+			LODRegion r ;
+			if(!r.parse(in))
+				return usage() ;
+			regions.push_back(r) ;
+		}
+		else if(arg == "-regions" && i + 1 < argc)
+		{
+			std::ifstream file(argv[++i]) ;
+			if(!file.good())
+			{
+				std::cerr << "could not read " << argv[i] << std::endl ;
+				return 1 ;
+			}
+			std::string line ;
+			while(std::getline(file, line))
+			{
+				size_t start = line.find_first_not_of(" \t\r") ;
+				if(start == std::string::npos || line[start] == '#')
+					continue ;
+				std::istringstream in(line) ;
+				LODRegion r ;
+				if(!r.parse(in))
+				{
+					std::cerr << "invalid region : " << line << std::endl ;
+					return 1 ;
+				}
+				regions.push_back(r) ;
+			}
+		}
+		else if(arg[0] == '-')
+			return usage() ;
+		else
+			inputs.push_back(arg) ;
+	}
+	if(inputs.empty() || regions.empty())
+		return usage() ;
+
+	//Les messages de la bibliothèque des différents threads s'entremêleraient
+	CGoGNout.toStd(options.verbose) ;
+
+	double start = wallClock() ;
+	std::vector<BuildTask> builds(inputs.size()) ;
+	for(unsigned int i = 0 ; i < inputs.size() ; ++i)
+	{
+		builds[i].input = inputs[i] ;
+		builds[i].cacheFile = options.outDir + "/" + baseName(inputs[i]) + ".vdpm" ;
+		builds[i].key = 0 ;
+		builds[i].ok = false ;
+	}
+	runTasks(builds, options) ;
+
+	std::vector<ExtractTask> extracts ;
+	for(unsigned int i = 0 ; i < builds.size() ; ++i)
+	{
+		for(unsigned int r = 0 ; r < regions.size() ; ++r)
+		{
+			ExtractTask t ;
+			t.build = &builds[i] ;
+			t.region = &regions[r] ;
+			std::ostringstream output ;
+			output << options.outDir << "/" << baseName(inputs[i]) << "_" << r << ".off" ;
+			t.output = output.str() ;
+			t.ok = false ;
+			extracts.push_back(t) ;
+		}
+	}
+	runTasks(extracts, options) ;
+
+	unsigned int failed = 0 ;
+	for(unsigned int i = 0 ; i < extracts.size() ; ++i)
+	{
+		if(!extracts[i].ok)
+			++failed ;
+	}
+	std::cout << extracts.size() - failed << "/" << extracts.size() << " régions extraites en "
+	          << wallClock() - start << " s" << std::endl ;
+	return failed == 0 ? 0 : 1 ;
+}
@@ -0,0 +1,927 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+/*
+ * Mesures des chemins critiques du maillage progressif sur des maillages synthétiques
+ * (sans Qt ni OpenGL, VDPMESH_HEADLESS) :
+ *
+ *   VDPMesh_Bench [options]
+ *     -sizes n1,n2,...    nombres de sommets visés (défaut : 10000,100000)
+ *     -shapes grid,sphere formes générées (défaut : les deux)
+ *     -p pourcentage      sommets conservés par la construction (défaut : 10)
+ *     -moves n            déplacements de la boîte (défaut : 20)
+ *     -samples n          opérations isolées mesurées (défaut : 1000)
+ *     -format json|csv    format de sortie (défaut : json)
+ *     -o fichier          sortie (défaut : sortie standard)
+ *     -tmp dossier        dossier des maillages générés (défaut : .)
+ *     -stream Mo          mesure aussi la construction hors mémoire avec ce budget
+ *     -check              vérifie le déterminisme des constructions au lieu de mesurer
+ *     -v                  messages de la bibliothèque
+ *
+ * Les maillages sont générés de façon déterministe (grille ondulée, icosaèdre
+ * subdivisé) et les opérations isolées sont tirées par un générateur fixe : deux
+ * versions comparées mesurent exactement le même travail. Chaque mesure donne le
+ * nombre d'échantillons, le débit (opérations/s) et les centiles de latence.
+ *
+ * Avec -stream, la construction hors mémoire (StreamingPMBuilder) est mesurée avant
+ * tout le reste, par tailles croissantes : le pic de mémoire résidente du processus
+ * (peak_rss_mb) ne fait que croître, si bien qu'une valeur stable d'une taille à
+ * l'autre montre que le budget tient quelle que soit la taille de l'entrée.
+ * bytes_per_face est l'estimation de mémoire par face retenue par le constructeur
+ * après mesure du premier morceau ; peak_rss_mb est aussi relevé après la
+ * construction en mémoire (createPM) pour comparaison.
+ *
+ * Avec -check, chaque maillage est construit plusieurs fois et les tables de noeuds
+ * et de VSplit sont comparées : deux constructions séquentielles, et deux
+ * constructions parallèles de même graine sur 1 thread et sur tous les threads,
+ * doivent être identiques ; les constructions séquentielle et parallèle (ordres de
+ * contraction différents) doivent donner des forêts valides sur les mêmes feuilles.
+ * Les mises à jour du front sont aussi vérifiées : après une suite de déplacements de
+ * la boîte et d'une sphère d'intérêt, un parcours complet du front ne doit plus rien
+ * changer aux mises à jour incrémentales, et la mise à jour parallèle doit donner le
+ * même front.
+ * Le code de retour est non nul en cas d'écart.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#include "Topology/generic/parameters.h"
+#include "Topology/generic/dartmarker.h"
+#include "Topology/map/embeddedMap2.h"
+
+#include "Algo/Import/import.h"
+#include "Algo/Geometry/boundingbox.h"
+
+#include "VDPMesh.h"
+#include "StreamingPM.h"
+#include "IndexBuffers.h"
+#include "FrontNormals.h"
+#include "VertexCache.h"
+
+using namespace CGoGN ;
+using namespace CGoGN::Algo::Surface::VDPMesh ;
+
+/*
+ * Générateur pseudo-aléatoire fixe (xorshift), identique sur toutes les plateformes
+ */
+class BenchRandom
+{
+public:
+	BenchRandom(unsigned int seed = 2463534242u) : m_state(seed) {}
+
+	unsigned int next()
+	{
+		m_state ^= m_state << 13 ;
+		m_state ^= m_state >> 17 ;
+		m_state ^= m_state << 5 ;
+		return m_state ;
+	}
+
+	unsigned int below(unsigned int n) { return n > 0 ? next() % n : 0 ; }
+
+private:
+	unsigned int m_state ;
+} ;
+
+/*
+ * Maillage synthétique au format OFF (sommets, triangles)
+ */
+struct SyntheticMesh
+{
+	std::vector<VEC3> vertices ;
+	std::vector<unsigned int> triangles ;
+
+	//Grille triangulée d'environ nbVertices sommets, ondulée pour varier les coûts de contraction
+	void grid(unsigned int nbVertices)
+	{
+		unsigned int side = std::max(2u, (unsigned int)std::sqrt(double(nbVertices))) ;
+		vertices.clear() ;
+		triangles.clear() ;
+		for(unsigned int j = 0 ; j < side ; ++j)
+		{
+			for(unsigned int i = 0 ; i < side ; ++i)
+			{
+				float x = float(i) / float(side - 1) ;
+				float y = float(j) / float(side - 1) ;
+				vertices.push_back(VEC3(x, y, 0.02f * std::sin(25.0f * x) * std::cos(17.0f * y))) ;
+			}
+		}
+		for(unsigned int j = 0 ; j + 1 < side ; ++j)
+		{
+			for(unsigned int i = 0 ; i + 1 < side ; ++i)
+			{
+				unsigned int a = j * side + i ;
+				unsigned int b = a + 1 ;
+				unsigned int c = a + side ;
+				unsigned int d = c + 1 ;
+				addTriangle(a, b, d) ;
+				addTriangle(a, d, c) ;
+			}
+		}
+	}
+
+	//Icosaèdre subdivisé jusqu'à atteindre nbVertices sommets (10 * 4^k + 2)
+	void sphere(unsigned int nbVertices)
+	{
+		const float t = (1.0f + std::sqrt(5.0f)) / 2.0f ;
+		const float ico[12][3] = {
+			{ -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+			{ 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+			{ t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 }
+		} ;
+		const unsigned int faces[20][3] = {
+			{ 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+			{ 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+			{ 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+			{ 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 }
+		} ;
+		vertices.clear() ;
+		triangles.clear() ;
+		for(unsigned int i = 0 ; i < 12 ; ++i)
+		{
+			VEC3 p(ico[i][0], ico[i][1], ico[i][2]) ;
+			p.normalize() ;
+			vertices.push_back(p) ;
+		}
+		for(unsigned int f = 0 ; f < 20 ; ++f)
+			addTriangle(faces[f][0], faces[f][1], faces[f][2]) ;
+
+		while(vertices.size() < nbVertices)
+		{
+			std::vector<unsigned int> coarse ;
+			coarse.swap(triangles) ;
+			std::map<std::pair<unsigned int, unsigned int>, unsigned int> middles ;
+			for(unsigned int f = 0 ; f < coarse.size() ; f += 3)
+			{
+				unsigned int a = coarse[f], b = coarse[f + 1], c = coarse[f + 2] ;
+				unsigned int ab = middle(a, b, middles) ;
+				unsigned int bc = middle(b, c, middles) ;
+				unsigned int ca = middle(c, a, middles) ;
+				addTriangle(a, ab, ca) ;
+				addTriangle(b, bc, ab) ;
+				addTriangle(c, ca, bc) ;
+				addTriangle(ab, bc, ca) ;
+			}
+		}
+	}
+
+	bool writeOFF(const std::string& filename) const
+	{
+		std::ofstream out(filename.c_str()) ;
+		if(!out.good())
+			return false ;
+		out.precision(9) ;
+		out << "OFF\n" << vertices.size() << " " << triangles.size() / 3 << " 0\n" ;
+		for(unsigned int i = 0 ; i < vertices.size() ; ++i)
+			out << vertices[i][0] << " " << vertices[i][1] << " " << vertices[i][2] << "\n" ;
+		for(unsigned int f = 0 ; f < triangles.size() ; f += 3)
+			out << "3 " << triangles[f] << " " << triangles[f + 1] << " " << triangles[f + 2] << "\n" ;
+		return out.good() ;
+	}
+
+private:
+	void addTriangle(unsigned int a, unsigned int b, unsigned int c)
+	{
+		triangles.push_back(a) ;
+		triangles.push_back(b) ;
+		triangles.push_back(c) ;
+	}
+
+	unsigned int middle(unsigned int a, unsigned int b, std::map<std::pair<unsigned int, unsigned int>, unsigned int>& middles)
+	{
+		std::pair<unsigned int, unsigned int> key(std::min(a, b), std::max(a, b)) ;
+		std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator it = middles.find(key) ;
+		if(it != middles.end())
+			return it->second ;
+		VEC3 p = vertices[a] + vertices[b] ;
+		p.normalize() ;
+		vertices.push_back(p) ;
+		middles[key] = vertices.size() - 1 ;
+		return vertices.size() - 1 ;
+	}
+} ;
+
+/*
+ * Résultat d'une mesure : latences des échantillons (s) et valeurs annexes
+ */
+struct BenchResult
+{
+	std::string mesh ;
+	unsigned int nbVertices ;
+	std::string name ;
+	std::vector<double> samples ;
+	double operations ;     //Opérations effectuées (débit = operations / temps total)
+	std::vector<std::pair<std::string, double> > extra ;
+
+	BenchResult(const std::string& m, unsigned int n, const std::string& b) : mesh(m), nbVertices(n), name(b), operations(0) {}
+
+	double total() const
+	{
+		double t = 0.0 ;
+		for(unsigned int i = 0 ; i < samples.size() ; ++i)
+			t += samples[i] ;
+		return t ;
+	}
+
+	//Centile q (0..1) par rang le plus proche
+	double percentile(double q) const
+	{
+		if(samples.empty())
+			return 0.0 ;
+		std::vector<double> sorted(samples) ;
+		std::sort(sorted.begin(), sorted.end()) ;
+		unsigned int rank = (unsigned int)std::ceil(q * double(sorted.size())) ;
+		return sorted[std::min((unsigned int)sorted.size() - 1, rank > 0 ? rank - 1 : 0)] ;
+	}
+
+	double throughput() const
+	{
+		double t = total() ;
+		return t > 0.0 ? operations / t : 0.0 ;
+	}
+} ;
+
+static void writeJSON(std::ostream& out, const std::vector<BenchResult>& results)
+{
+	out << "[\n" ;
+	for(unsigned int i = 0 ; i < results.size() ; ++i)
+	{
+		const BenchResult& r = results[i] ;
+		out << "  { \"mesh\": \"" << r.mesh << "\", \"vertices\": " << r.nbVertices << ", \"bench\": \"" << r.name << "\""
+		    << ", \"samples\": " << r.samples.size() << ", \"operations\": " << r.operations
+		    << ", \"total_s\": " << r.total() << ", \"ops_per_s\": " << r.throughput()
+		    << ", \"p50_ms\": " << 1e3 * r.percentile(0.5) << ", \"p90_ms\": " << 1e3 * r.percentile(0.9)
+		    << ", \"p99_ms\": " << 1e3 * r.percentile(0.99) << ", \"max_ms\": " << 1e3 * r.percentile(1.0) ;
+		for(unsigned int k = 0 ; k < r.extra.size() ; ++k)
+			out << ", \"" << r.extra[k].first << "\": " << r.extra[k].second ;
+		out << " }" << (i + 1 < results.size() ? "," : "") << "\n" ;
+	}
+	out << "]\n" ;
+}
+
+static void writeCSV(std::ostream& out, const std::vector<BenchResult>& results)
+{
+	out << "mesh,vertices,bench,samples,operations,total_s,ops_per_s,p50_ms,p90_ms,p99_ms,max_ms,extra\n" ;
+	for(unsigned int i = 0 ; i < results.size() ; ++i)
+	{
+		const BenchResult& r = results[i] ;
+		out << r.mesh << "," << r.nbVertices << "," << r.name << "," << r.samples.size() << "," << r.operations
+		    << "," << r.total() << "," << r.throughput() << "," << 1e3 * r.percentile(0.5) << "," << 1e3 * r.percentile(0.9)
+		    << "," << 1e3 * r.percentile(0.99) << "," << 1e3 * r.percentile(1.0) << "," ;
+		for(unsigned int k = 0 ; k < r.extra.size() ; ++k)
+			out << (k > 0 ? ";" : "") << r.extra[k].first << "=" << r.extra[k].second ;
+		out << "\n" ;
+	}
+}
+
+struct BenchOptions
+{
+	std::vector<unsigned int> sizes ;
+	std::vector<std::string> shapes ;
+	unsigned int percent ;
+	unsigned int moves ;
+	unsigned int samples ;
+	std::string tmpDir ;
+	unsigned int streamBudget ;     //Mo, 0 : construction hors mémoire non mesurée
+
+	bool check ;
+
+	BenchOptions() : percent(10), moves(20), samples(1000), tmpDir("."), streamBudget(0), check(false) {}
+} ;
+
+/*
+ * Tables d'une forêt construite, comparables entre deux constructions
+ */
+struct ForestTables
+{
+	std::vector<unsigned int> nodes ;   //Parent, fils, sommet, hauteur, activité, VSplit
+	std::vector<unsigned int> splits ;  //Brins puis lignes d'approximation
+	unsigned int nbLeaves ;
+	int height ;
+	bool valid ;
+
+	ForestTables() : nbLeaves(0), height(0), valid(false) {}
+
+	bool operator==(const ForestTables& t) const
+	{
+		return nodes == t.nodes && splits == t.splits && height == t.height ;
+	}
+
+	//Les nbLeaves premiers noeuds sont les feuilles, créées dans l'ordre des sommets
+	bool sameLeaves(const ForestTables& t) const
+	{
+		if(nbLeaves != t.nbLeaves)
+			return false ;
+		for(unsigned int n = 0 ; n < nbLeaves ; ++n)
+		{
+			if(nodes[NODE_FIELDS * n + 3] != t.nodes[NODE_FIELDS * n + 3])
+				return false ;
+		}
+		return true ;
+	}
+
+	static const unsigned int NODE_FIELDS = 7 ;
+} ;
+
+/*
+ * Forêt valide : fils avant leur parent et réciproques, hauteur 1 + max des fils,
+ * VSplit pour les seuls noeuds internes, m_height maximal
+ */
+template <typename PFP>
+static bool checkForest(VDProgressiveMesh<PFP>& pmesh)
+{
+	const NodePool& nodes = pmesh.getNodes() ;
+	int height = 0 ;
+	for(unsigned int n = 0 ; n < nodes.size() ; ++n)
+	{
+		unsigned int left = nodes.getLeftChild(n) ;
+		unsigned int right = nodes.getRightChild(n) ;
+		if((left == NO_NODE) != (right == NO_NODE))
+			return false ;
+		if(left == NO_NODE)
+		{
+			if(nodes.getVSplit(n) != NO_SPLIT || nodes.getHeight(n) != 0)
+				return false ;
+			continue ;
+		}
+		if(left >= n || right >= n || nodes.getParent(left) != n || nodes.getParent(right) != n
+		|| nodes.getVSplit(n) == NO_SPLIT
+		|| nodes.getHeight(n) != 1 + std::max(nodes.getHeight(left), nodes.getHeight(right)))
+			return false ;
+		height = std::max(height, nodes.getHeight(n)) ;
+	}
+	return height == pmesh.getForestHeight() ;
+}
+
+/*
+ * Construction sur une carte neuve importée du fichier, threads = 0 : tous les threads
+ */
+static bool buildForest(const std::string& file, BuildMode mode, int threads, const BenchOptions& options, ForestTables& t)
+{
+	PFP::MAP map ;
+	std::vector<std::string> attrNames ;
+	if(!Algo::Surface::Import::importMesh<PFP>(map, file.c_str(), attrNames))
+		return false ;
+	VertexAttribute<VEC3> position = map.getAttribute<VEC3, VERTEX>(attrNames[0]) ;
+	Geom::BoundingBox<VEC3> bb = Algo::Geometry::computeBoundingBox<PFP>(map, position) ;
+	t.nbLeaves = map.getNbOrbits<VERTEX>() ;
+
+	DartMarker inactive(map) ;
+	VDProgressiveMesh<PFP> pmesh(map, inactive, position, bb) ;
+	pmesh.setBuildMode(mode) ;
+#ifdef _OPENMP
+	int previous = omp_get_max_threads() ;
+	if(threads > 0)
+		omp_set_num_threads(threads) ;
+#endif
+	pmesh.createPM(options.percent) ;
+#ifdef _OPENMP
+	omp_set_num_threads(previous) ;
+#endif
+
+	const NodePool& nodes = pmesh.getNodes() ;
+	t.nodes.clear() ;
+	for(unsigned int n = 0 ; n < nodes.size() ; ++n)
+	{
+		unsigned int fields[ForestTables::NODE_FIELDS] = {
+			nodes.getParent(n), nodes.getLeftChild(n), nodes.getRightChild(n), nodes.getVertex(n),
+			(unsigned int)nodes.getHeight(n), nodes.isActive(n) ? 1u : 0u, nodes.getVSplit(n)
+		} ;
+		t.nodes.insert(t.nodes.end(), fields, fields + ForestTables::NODE_FIELDS) ;
+	}
+	const std::vector<VSplit>& splits = pmesh.getSplits() ;
+	t.splits.clear() ;
+	for(unsigned int i = 0 ; i < splits.size() ; ++i)
+	{
+		const VSplit& vs = splits[i] ;
+		unsigned int fields[6] = {
+			vs.getEdge().index, vs.getLeftEdge().index, vs.getRightEdge().index,
+			vs.getApproxV(), vs.getApproxE1(), vs.getApproxE2()
+		} ;
+		t.splits.insert(t.splits.end(), fields, fields + 6) ;
+	}
+	t.height = pmesh.getForestHeight() ;
+	t.valid = checkForest(pmesh) ;
+	return true ;
+}
+
+/*
+ * Noeuds actifs, dans l'ordre du pool
+ */
+template <typename PFP>
+static void frontOf(VDProgressiveMesh<PFP>& pmesh, std::vector<unsigned int>& front)
+{
+	const NodePool& nodes = pmesh.getNodes() ;
+	front.clear() ;
+	for(unsigned int n = 0 ; n < nodes.size() ; ++n)
+	{
+		if(nodes.isActive(n))
+			front.push_back(n) ;
+	}
+}
+
+/*
+ * Suite de déplacements de la boîte et d'une sphère d'intérêt, suivis de mises à jour
+ * incrémentales (différence symétrique des boîtes, régions touchées) ou parallèles ;
+ * rescanned est le front après un parcours complet du front obtenu
+ */
+static bool moveFront(const std::string& file, const BenchOptions& options, bool parallel,
+                      std::vector<unsigned int>& front, std::vector<unsigned int>& rescanned)
+{
+	PFP::MAP map ;
+	std::vector<std::string> attrNames ;
+	if(!Algo::Surface::Import::importMesh<PFP>(map, file.c_str(), attrNames))
+		return false ;
+	VertexAttribute<VEC3> position = map.getAttribute<VEC3, VERTEX>(attrNames[0]) ;
+	Geom::BoundingBox<VEC3> bb = Algo::Geometry::computeBoundingBox<PFP>(map, position) ;
+
+	DartMarker inactive(map) ;
+	VDProgressiveMesh<PFP> pmesh(map, inactive, position, bb) ;
+	pmesh.createPM(options.percent) ;
+
+	VEC3 extent = (bb.max() - bb.min()) * 0.2f ;
+	float radius = extent.norm() * 0.25f ;
+	unsigned int sphere = pmesh.addInterestSphere(bb.max() - extent, radius) ;
+	unsigned int moves = std::max(options.moves, 2u) ;
+	for(unsigned int i = 0 ; i < moves ; ++i)
+	{
+		float t = float(i) / float(moves - 1) ;
+		VEC3 pos_min = bb.min() + (bb.max() - bb.min() - extent) * t ;
+		pmesh.getInterestBox()->setPosMin(pos_min) ;
+		pmesh.getInterestBox()->setPosMax(pos_min + extent) ;
+		pmesh.moveInterestSphere(sphere, bb.max() - extent * (1.0f + 3.0f * t), radius) ;
+		if(parallel)
+			pmesh.updateRefinementParallel() ;
+		else
+			pmesh.updateRefinement() ;
+	}
+	frontOf(pmesh, front) ;
+	pmesh.invalidateRefinement() ;
+	pmesh.updateRefinement() ;
+	frontOf(pmesh, rescanned) ;
+	return true ;
+}
+
+static bool report(const std::string& what, bool ok)
+{
+	std::cerr << "  " << what << " : " << (ok ? "ok" : "MISMATCH") << std::endl ;
+	return ok ;
+}
+
+/*
+ * Déterminisme des constructions sur un maillage (voir -check)
+ */
+static bool checkMesh(const std::string& shape, unsigned int size, const BenchOptions& options, bool& identical)
+{
+	SyntheticMesh synthetic ;
+	if(shape == "sphere")
+		synthetic.sphere(size) ;
+	else
+		synthetic.grid(size) ;
+	std::ostringstream file ;
+	file << options.tmpDir << "/check_" << shape << "_" << size << ".off" ;
+	if(!synthetic.writeOFF(file.str()))
+		return false ;
+
+	ForestTables serial[2], parallel[2] ;
+	bool built = buildForest(file.str(), BUILD_SERIAL, 0, options, serial[0])
+	          && buildForest(file.str(), BUILD_SERIAL, 0, options, serial[1])
+	          && buildForest(file.str(), BUILD_PARALLEL, 1, options, parallel[0])
+	          && buildForest(file.str(), BUILD_PARALLEL, 0, options, parallel[1]) ;
+	std::vector<unsigned int> incremental, rescanned, parallelFront, parallelRescanned ;
+	built = built && moveFront(file.str(), options, false, incremental, rescanned)
+	              && moveFront(file.str(), options, true, parallelFront, parallelRescanned) ;
+	std::remove(file.str().c_str()) ;
+	if(!built)
+		return false ;
+
+	std::cerr << std::endl ;
+	identical = report("serial forest valid", serial[0].valid) ;
+	identical = report("parallel forest valid", parallel[0].valid && parallel[1].valid) && identical ;
+	identical = report("serial repeated", serial[0] == serial[1]) && identical ;
+	identical = report("parallel 1 thread / all threads", parallel[0] == parallel[1]) && identical ;
+	identical = report("serial / parallel leaves", serial[0].sameLeaves(parallel[0])) && identical ;
+	identical = report("incremental / full rescan front", incremental == rescanned) && identical ;
+	identical = report("incremental / parallel front", incremental == parallelFront) && identical ;
+	std::cerr << "  serial " << serial[0].nodes.size() / ForestTables::NODE_FIELDS << " nodes, height " << serial[0].height
+	          << " ; parallel " << parallel[0].nodes.size() / ForestTables::NODE_FIELDS << " nodes, height " << parallel[0].height << std::endl ;
+	return true ;
+}
+
+/*
+ * Noeuds actifs internes (raffinables), tirés dans l'ordre du générateur
+ */
+template <typename PFP>
+static void pickActiveInternal(VDProgressiveMesh<PFP>& pmesh, unsigned int count, BenchRandom& random, std::vector<unsigned int>& picked)
+{
+	const NodePool& nodes = pmesh.getNodes() ;
+	std::vector<unsigned int> candidates ;
+	for(unsigned int n = 0 ; n < nodes.size() ; ++n)
+	{
+		if(nodes.isActive(n) && nodes.getVSplit(n) != NO_SPLIT)
+			candidates.push_back(n) ;
+	}
+	picked.clear() ;
+	for(unsigned int i = 0 ; i < count && !candidates.empty() ; ++i)
+	{
+		unsigned int k = random.below(candidates.size()) ;
+		picked.push_back(candidates[k]) ;
+		candidates[k] = candidates.back() ;
+		candidates.pop_back() ;
+	}
+}
+
+/*
+ * Toutes les mesures sur un maillage
+ */
+static bool benchMesh(const std::string& shape, unsigned int size, const BenchOptions& options, std::vector<BenchResult>& results)
+{
+	SyntheticMesh synthetic ;
+	if(shape == "sphere")
+		synthetic.sphere(size) ;
+	else
+		synthetic.grid(size) ;
+	std::ostringstream file ;
+	file << options.tmpDir << "/bench_" << shape << "_" << size << ".off" ;
+	if(!synthetic.writeOFF(file.str()))
+		return false ;
+
+	PFP::MAP map ;
+	std::vector<std::string> attrNames ;
+	bool imported = Algo::Surface::Import::importMesh<PFP>(map, file.str().c_str(), attrNames) ;
+	std::remove(file.str().c_str()) ;
+	if(!imported)
+		return false ;
+	VertexAttribute<VEC3> position = map.getAttribute<VEC3, VERTEX>(attrNames[0]) ;
+	Geom::BoundingBox<VEC3> bb = Algo::Geometry::computeBoundingBox<PFP>(map, position) ;
+	unsigned int nbVertices = synthetic.vertices.size() ;
+	BenchRandom random ;
+
+	DartMarker inactive(map) ;
+	VDProgressiveMesh<PFP> pmesh(map, inactive, position, bb) ;
+
+	/*Construction de la hiérarchie (une contraction par opération)*/
+	{
+		BenchResult r(shape, nbVertices, "createPM") ;
+		double start = wallClock() ;
+		pmesh.createPM(options.percent) ;
+		r.samples.push_back(wallClock() - start) ;
+		r.operations = pmesh.getNodes().size() - nbVertices ;
+		r.extra.push_back(std::make_pair(std::string("roots"), double(pmesh.getFront().size()))) ;
+		r.extra.push_back(std::make_pair(std::string("peak_rss_mb"), double(peakMemory()) / (1024 * 1024))) ;
+		results.push_back(r) ;
+	}
+	position = map.getAttribute<VEC3, VERTEX>(attrNames[0]) ;
+
+	/*Mise à jour du raffinement pour une boîte de 20% de la taille qui traverse le modèle*/
+	pmesh.setChangeTracking(true) ;
+	{
+		BenchResult r(shape, nbVertices, "updateRefinement") ;
+		VEC3 extent = (bb.max() - bb.min()) * 0.2f ;
+		for(unsigned int i = 0 ; i < options.moves ; ++i)
+		{
+			float t = options.moves > 1 ? float(i) / float(options.moves - 1) : 0.0f ;
+			VEC3 pos_min = bb.min() + (bb.max() - bb.min() - extent) * t ;
+			pmesh.getInterestBox()->setPosMin(pos_min) ;
+			pmesh.getInterestBox()->setPosMax(pos_min + extent) ;
+			unsigned int before = pmesh.getChanges().nodes.size() ;
+			double start = wallClock() ;
+			pmesh.updateRefinement() ;
+			r.samples.push_back(wallClock() - start) ;
+			//Chaque transformation note trois noeuds
+			r.operations += double(pmesh.getChanges().nodes.size() - before) / 3.0 ;
+		}
+		r.extra.push_back(std::make_pair(std::string("front"), double(pmesh.getFront().size()))) ;
+		results.push_back(r) ;
+	}
+
+	/*Primitives d'affichage : construction complète, puis mises à jour incrémentales*/
+	{
+		FrontBuffers<PFP> buffers ;
+		VertexAttribute<VEC3> normal = map.getAttribute<VEC3, VERTEX>("normal") ;
+		if(!normal.isValid())
+			normal = map.addAttribute<VEC3, VERTEX>("normal") ;
+
+		BenchResult full(shape, nbVertices, "buildBuffers") ;
+		double start = wallClock() ;
+		buffers.build(map, inactive, pmesh.getNodes()) ;
+		Algo::Surface::Geometry::computeNormalVertices<PFP>(map, position, normal) ;
+		full.samples.push_back(wallClock() - start) ;
+		full.operations = buffers.triangles.nbPrimitives() ;
+		pmesh.getChanges().clear() ;
+
+		CacheOrderedTriangles<PFP> ordered ;
+		start = wallClock() ;
+		ordered.update(buffers.triangles, position) ;
+		full.extra.push_back(std::make_pair(std::string("order_ms"), 1e3 * (wallClock() - start))) ;
+		full.extra.push_back(std::make_pair(std::string("acmr_before"), double(acmr(buffers.triangles.indices())))) ;
+		full.extra.push_back(std::make_pair(std::string("acmr_after"), double(acmr(ordered.indices())))) ;
+		buffers.clearDirty() ;
+		ordered.clearDirty() ;
+		results.push_back(full) ;
+
+		BenchResult incremental(shape, nbVertices, "patchBuffers") ;
+		FrontNormals<PFP> normals ;
+		VEC3 extent = (bb.max() - bb.min()) * 0.2f ;
+		for(unsigned int i = 0 ; i < options.moves ; ++i)
+		{
+			float t = options.moves > 1 ? 1.0f - float(i) / float(options.moves - 1) : 0.0f ;
+			VEC3 pos_min = bb.min() + (bb.max() - bb.min() - extent) * t ;
+			pmesh.getInterestBox()->setPosMin(pos_min) ;
+			pmesh.getInterestBox()->setPosMax(pos_min + extent) ;
+			pmesh.updateRefinement() ;
+			incremental.operations += pmesh.getChanges().darts.size() ;
+			start = wallClock() ;
+			normals.update(map, inactive, position, normal, pmesh.getChanges()) ;
+			buffers.apply(map, inactive, pmesh.getNodes(), pmesh.getChanges()) ;
+			ordered.update(buffers.triangles, position) ;
+			incremental.samples.push_back(wallClock() - start) ;
+			buffers.clearDirty() ;
+			ordered.clearDirty() ;
+		}
+		incremental.extra.push_back(std::make_pair(std::string("acmr_after"), double(acmr(ordered.indices())))) ;
+		results.push_back(incremental) ;
+	}
+	pmesh.setChangeTracking(false) ;
+
+	/*Transformations isolées : VSplit puis contraction des mêmes noeuds*/
+	{
+		std::vector<unsigned int> picked ;
+		pickActiveInternal(pmesh, options.samples, random, picked) ;
+		BenchResult split(shape, nbVertices, "refine") ;
+		BenchResult collapse(shape, nbVertices, "coarsen") ;
+		unsigned int rejected = 0 ;
+		std::vector<unsigned int> refined ;
+		for(unsigned int i = 0 ; i < picked.size() ; ++i)
+		{
+			double start = wallClock() ;
+			bool ok = pmesh.refine(picked[i]) ;
+			split.samples.push_back(wallClock() - start) ;
+			if(ok)
+				refined.push_back(picked[i]) ;
+			else
+				++rejected ;
+		}
+		split.operations = refined.size() ;
+		split.extra.push_back(std::make_pair(std::string("rejected"), double(rejected))) ;
+		rejected = 0 ;
+		for(unsigned int i = refined.size() ; i-- > 0 ; )
+		{
+			double start = wallClock() ;
+			bool ok = pmesh.coarsen(pmesh.getNodes().getLeftChild(refined[i])) ;
+			collapse.samples.push_back(wallClock() - start) ;
+			if(ok)
+				collapse.operations += 1 ;
+			else
+				++rejected ;
+		}
+		collapse.extra.push_back(std::make_pair(std::string("rejected"), double(rejected))) ;
+		results.push_back(split) ;
+		results.push_back(collapse) ;
+	}
+
+	/*Raffinement forcé jusqu'à des feuilles tirées au hasard (le maillage s'affine au fil des tirages)*/
+	{
+		BenchResult force(shape, nbVertices, "forceRefine") ;
+		const NodePool& nodes = pmesh.getNodes() ;
+		unsigned int failed = 0 ;
+		for(unsigned int i = 0 ; i < options.samples ; ++i)
+		{
+			//Les feuilles sont les premiers noeuds du pool
+			unsigned int leaf = random.below(nbVertices) ;
+			unsigned int before = pmesh.getFront().size() ;
+			double start = wallClock() ;
+			pmesh.forceRefine(leaf) ;
+			force.samples.push_back(wallClock() - start) ;
+			force.operations += pmesh.getFront().size() - before ;
+			if(!nodes.isActive(leaf))
+				++failed ;
+		}
+		force.extra.push_back(std::make_pair(std::string("failed"), double(failed))) ;
+		results.push_back(force) ;
+	}
+	return true ;
+}
+
+/*
+ * Construction hors mémoire d'un maillage dans le dossier temporaire
+ */
+static bool streamMesh(const std::string& shape, unsigned int size, const BenchOptions& options, std::vector<BenchResult>& results)
+{
+	SyntheticMesh synthetic ;
+	if(shape == "sphere")
+		synthetic.sphere(size) ;
+	else
+		synthetic.grid(size) ;
+	std::ostringstream file ;
+	file << options.tmpDir << "/stream_" << shape << "_" << size << ".off" ;
+	if(!synthetic.writeOFF(file.str()))
+		return false ;
+
+	StreamingPMBuilder<PFP> builder(options.tmpDir, size_t(options.streamBudget) * 1024 * 1024) ;
+	builder.setPercentWantedVertices(options.percent) ;
+	BenchResult r(shape, synthetic.vertices.size(), "streamingBuild") ;
+	double start = wallClock() ;
+	bool ok = builder.build(file.str()) ;
+	r.samples.push_back(wallClock() - start) ;
+	r.operations = synthetic.triangles.size() / 3 ;
+	r.extra.push_back(std::make_pair(std::string("budget_mb"), double(options.streamBudget))) ;
+	r.extra.push_back(std::make_pair(std::string("peak_rss_mb"), double(peakMemory()) / (1024 * 1024))) ;
+	r.extra.push_back(std::make_pair(std::string("bytes_per_face"), double(builder.getBytesPerFace()))) ;
+	r.extra.push_back(std::make_pair(std::string("chunks"), double(builder.nbChunks()))) ;
+	results.push_back(r) ;
+
+	/*Fichiers de travail*/
+	std::remove(file.str().c_str()) ;
+	const char* names[] = { "positions.bin", "seam.bin", "top.off", "top.off.vdpm", "top.off.vdpm.map", "top.roots", "manifest.txt" } ;
+	for(unsigned int i = 0 ; i < sizeof(names) / sizeof(names[0]) ; ++i)
+		std::remove((options.tmpDir + "/" + names[i]).c_str()) ;
+	const char* exts[] = { "faces", "ids", "roots", "vdpm", "vdpm.map" } ;
+	for(unsigned int c = 0 ; c < builder.nbChunks() ; ++c)
+	{
+		for(unsigned int i = 0 ; i < sizeof(exts) / sizeof(exts[0]) ; ++i)
+		{
+			std::ostringstream chunk ;
+			chunk << options.tmpDir << "/chunk_" << c << "." << exts[i] ;
+			std::remove(chunk.str().c_str()) ;
+		}
+	}
+	return ok ;
+}
+
+static void split(const std::string& list, std::vector<std::string>& items)
+{
+	std::istringstream in(list) ;
+	std::string item ;
+	while(std::getline(in, item, ','))
+	{
+		if(!item.empty())
+			items.push_back(item) ;
+	}
+}
+
+static int usage()
+{
+	std::cerr << "usage : VDPMesh_Bench [-sizes n1,n2,...] [-shapes grid,sphere] [-p pourcentage] [-moves n]"
+	          << " [-samples n] [-format json|csv] [-o fichier] [-tmp dossier] [-stream Mo] [-check] [-v]" << std::endl ;
+	return 2 ;
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options ;
+	std::string format("json") ;
+	std::string output ;
+	bool verbose = false ;
+
+	for(int i = 1 ; i < argc ; ++i)
+	{
+		std::string arg(argv[i]) ;
+		if(arg == "-sizes" && i + 1 < argc)
+		{
+			std::vector<std::string> items ;
+			split(argv[++i], items) ;
+			for(unsigned int k = 0 ; k < items.size() ; ++k)
+				options.sizes.push_back(atoi(items[k].c_str())) ;
+		}
+		else if(arg == "-shapes" && i + 1 < argc)
+			split(argv[++i], options.shapes) ;
+		else if(arg == "-p" && i + 1 < argc)
+			options.percent = atoi(argv[++i]) ;
+		else if(arg == "-moves" && i + 1 < argc)
+			options.moves = atoi(argv[++i]) ;
+		else if(arg == "-samples" && i + 1 < argc)
+			options.samples = atoi(argv[++i]) ;
+		else if(arg == "-format" && i + 1 < argc)
+			format = argv[++i] ;
+		else if(arg == "-o" && i + 1 < argc)
+			output = argv[++i] ;
+		else if(arg == "-tmp" && i + 1 < argc)
+			options.tmpDir = argv[++i] ;
+		else if(arg == "-stream" && i + 1 < argc)
+			options.streamBudget = atoi(argv[++i]) ;
+		else if(arg == "-check")
+			options.check = true ;
+		else if(arg == "-v")
+			verbose = true ;
+		else
+			return usage() ;
+	}
+	if(format != "json" && format != "csv")
+		return usage() ;
+	if(options.sizes.empty())
+	{
+		options.sizes.push_back(10000) ;
+		options.sizes.push_back(100000) ;
+	}
+	if(options.shapes.empty())
+	{
+		options.shapes.push_back("grid") ;
+		options.shapes.push_back("sphere") ;
+	}
+
+	CGoGNout.toStd(verbose) ;
+
+	if(options.check)
+	{
+		bool identical = true ;
+		for(unsigned int s = 0 ; s < options.shapes.size() ; ++s)
+		{
+			for(unsigned int k = 0 ; k < options.sizes.size() ; ++k)
+			{
+				std::cerr << options.shapes[s] << " " << options.sizes[k] << ".." << std::flush ;
+				bool ok = false ;
+				if(!checkMesh(options.shapes[s], options.sizes[k], options, ok))
+				{
+					std::cerr << "failed" << std::endl ;
+					return 1 ;
+				}
+				identical = identical && ok ;
+			}
+		}
+		return identical ? 0 : 1 ;
+	}
+
+	std::vector<BenchResult> results ;
+	if(options.streamBudget > 0)
+	{
+		//Pic de mémoire du processus : hors mémoire d'abord, par tailles croissantes
+		std::vector<unsigned int> sizes(options.sizes) ;
+		std::sort(sizes.begin(), sizes.end()) ;
+		for(unsigned int s = 0 ; s < options.shapes.size() ; ++s)
+		{
+			for(unsigned int k = 0 ; k < sizes.size() ; ++k)
+			{
+				std::cerr << "stream " << options.shapes[s] << " " << sizes[k] << ".." << std::flush ;
+				double start = wallClock() ;
+				if(!streamMesh(options.shapes[s], sizes[k], options, results))
+				{
+					std::cerr << "failed" << std::endl ;
+					return 1 ;
+				}
+				std::cerr << wallClock() - start << " s" << std::endl ;
+			}
+		}
+	}
+	for(unsigned int s = 0 ; s < options.shapes.size() ; ++s)
+	{
+		for(unsigned int k = 0 ; k < options.sizes.size() ; ++k)
+		{
+			std::cerr << options.shapes[s] << " " << options.sizes[k] << ".." << std::flush ;
+			double start = wallClock() ;
+			if(!benchMesh(options.shapes[s], options.sizes[k], options, results))
+			{
+				std::cerr << "failed" << std::endl ;
+				return 1 ;
+			}
+			std::cerr << wallClock() - start << " s" << std::endl ;
+		}
+	}
+
+	std::ofstream file ;
+	if(!output.empty())
+	{
+		file.open(output.c_str()) ;
+		if(!file.good())
+		{
+			std::cerr << "could not write " << output << std::endl ;
+			return 1 ;
+		}
+	}
+	std::ostream& out = output.empty() ? std::cout : file ;
+	if(format == "csv")
+		writeCSV(out, results) ;
+	else
+		writeJSON(out, results) ;
+	return 0 ;
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __ACTIVE_FRONT_H__
+#define __ACTIVE_FRONT_H__
+
+#include <vector>
+
+#include "Node.h"
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Front courant de la forêt : tableau dense des noeuds actifs.
+ * Chaque noeud connaît sa case (NodePool::getSlot), ce qui permet l'insertion en fin
+ * de tableau et le retrait par échange avec la dernière case, tous deux en O(1).
+ *
+ * Pendant un parcours (entre beginScan et endScan), un retrait laisse une case vide
+ * (NO_NODE) au lieu de déplacer la dernière case : les noeuds ne changent pas de
+ * case, et un parcours par indice croissant voit chaque noeud au plus une fois,
+ * ainsi que ceux ajoutés en fin de tableau pendant le parcours. Les cases vides sont
+ * compactées (en conservant l'ordre) à la fin du parcours le plus externe.
+ */
+class ActiveFront
+{
+public:
+	ActiveFront(NodePool& nodes) : m_nodes(nodes), m_holes(0), m_scanning(0) {}
+
+	/*Nombre de noeuds actifs*/
+	unsigned int size() const { return m_slots.size() - m_holes ; }
+	bool empty() const { return size() == 0 ; }
+
+	/*Nombre de cases, cases vides comprises, et contenu d'une case*/
+	unsigned int slotCount() const { return m_slots.size() ; }
+	unsigned int at(unsigned int slot) const { return m_slots[slot] ; }
+
+	void reserve(unsigned int n) { m_slots.reserve(n) ; }
+	size_t memory() const { return m_slots.capacity() * sizeof(unsigned int) ; }
+
+	void clear()
+	{
+		m_slots.clear() ;
+		m_holes = 0 ;
+		m_scanning = 0 ;
+	}
+
+	void insert(unsigned int n)
+	{
+		m_nodes.setSlot(n, m_slots.size()) ;
+		m_slots.push_back(n) ;
+	}
+
+	void remove(unsigned int n)
+	{
+		unsigned int slot = m_nodes.getSlot(n) ;
+		m_nodes.setSlot(n, NO_SLOT) ;
+		if(m_scanning > 0)
+		{
+			m_slots[slot] = NO_NODE ;
+			++m_holes ;
+			return ;
+		}
+		unsigned int last = m_slots.back() ;
+		m_slots.pop_back() ;
+		if(last != n)
+		{
+			m_slots[slot] = last ;
+			m_nodes.setSlot(last, slot) ;
+		}
+	}
+
+	void beginScan() { ++m_scanning ; }
+
+	//Sans effet si le front a été vidé depuis beginScan
+	void endScan()
+	{
+		if(m_scanning == 0)
+			return ;
+		if(--m_scanning == 0 && m_holes > 0)
+			compact() ;
+	}
+
+private:
+	NodePool& m_nodes ;
+	std::vector<unsigned int> m_slots ;
+	unsigned int m_holes ;      //Cases vides laissées par les retraits en cours de parcours
+	unsigned int m_scanning ;   //Profondeur des parcours en cours
+
+	void compact()
+	{
+		unsigned int j = 0 ;
+		for(unsigned int i = 0 ; i < m_slots.size() ; ++i)
+		{
+			unsigned int n = m_slots[i] ;
+			if(n == NO_NODE)
+				continue ;
+			m_slots[j] = n ;
+			m_nodes.setSlot(n, j) ;
+			++j ;
+		}
+		m_slots.resize(j) ;
+		m_holes = 0 ;
+	}
+
+	ActiveFront(const ActiveFront&) ;
+	ActiveFront& operator=(const ActiveFront&) ;
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -1,6 +1,13 @@
 #ifndef __BOX_H__
 #define __BOX_H__
 
+#include <cmath>
+
+/*Sans affichage (VDPMESH_HEADLESS) : ni drawer ni OpenGL*/
+#ifndef VDPMESH_HEADLESS
+#include "Utils/drawer.h"
+#endif
+
 namespace CGoGN {
 
 namespace Algo {
@@ -16,20 +23,24 @@ struct Box {
     public:
         Box(PFP::VEC3 pos_min = PFP::VEC3(-2., -2., -2.), PFP::VEC3 pos_max = PFP::VEC3(2., 2., 2.))
         	: m_pos_min(pos_min), m_pos_max(pos_max)
-        {
-        	m_drawer = new Utils::Drawer();
-        }
+#ifndef VDPMESH_HEADLESS
+        	, m_drawer(NULL)
+#endif
+        {}
         
         Box(Geom::BoundingBox<PFP::VEC3> bb)
         	: m_pos_min(bb.min()), m_pos_max(bb.max())
-        {
-        	m_drawer = new Utils::Drawer();
-        }
+#ifndef VDPMESH_HEADLESS
+        	, m_drawer(NULL)
+#endif
+        {}
 
+#ifndef VDPMESH_HEADLESS
         ~Box()
         {
         	delete m_drawer;
         }
+#endif
 
         PFP::VEC3 getPosMin() { return m_pos_min; }
         void setPosMin(PFP::VEC3 pos_min) { m_pos_min = pos_min; }
@@ -41,9 +52,16 @@ struct Box {
         void incPosMax(float inc, unsigned int dir) { m_pos_max[dir] += inc; }
         void decPosMax(float inc, unsigned int dir) { m_pos_max[dir] -= inc; }
 
-        Utils::Drawer* getDrawer() { return m_drawer; }
+#ifndef VDPMESH_HEADLESS
+        //Le drawer n'est créé qu'au premier affichage (contexte OpenGL requis)
+        Utils::Drawer* getDrawer() {
+        	if(!m_drawer)
+        		m_drawer = new Utils::Drawer();
+        	return m_drawer;
+        }
 
         void updateDrawer() {
+        	getDrawer();
         	VEC3 a = m_pos_min;
         	VEC3 b = VEC3(m_pos_max[0], m_pos_min[1], m_pos_min[2]);
         	VEC3 c = VEC3(m_pos_max[0], m_pos_max[1], m_pos_min[2]);
@@ -75,6 +93,7 @@ struct Box {
         	m_drawer->end();
         	m_drawer->endList();
         }
+#endif
 
         bool contains(PFP::VEC3 pos) {
         	return 	m_pos_min[0] <= pos[0] && pos[0] <= m_pos_max[0]
@@ -82,6 +101,31 @@ struct Box {
 			 &&		m_pos_min[2] <= pos[2] && pos[2] <= m_pos_max[2];
         }
 
+        //Vrai si la sphère (centre, rayon) touche la boîte
+        bool intersects(PFP::VEC3 center, float radius) {
+        	return intersects(m_pos_min, m_pos_max, center, radius);
+        }
+
+        static bool intersects(const PFP::VEC3& pos_min, const PFP::VEC3& pos_max, const PFP::VEC3& center, float radius) {
+        	return distance2(pos_min, pos_max, center) <= radius * radius;
+        }
+
+        //Distance d'un point à la boîte (0 à l'intérieur)
+        float distance(PFP::VEC3 pos) {
+        	return std::sqrt(distance2(m_pos_min, m_pos_max, pos));
+        }
+
+        static float distance2(const PFP::VEC3& pos_min, const PFP::VEC3& pos_max, const PFP::VEC3& pos) {
+        	float dist2 = 0.0f;
+        	for(unsigned int i = 0; i < 3; ++i) {
+        		if(pos[i] < pos_min[i])
+        			dist2 += (pos_min[i] - pos[i]) * (pos_min[i] - pos[i]);
+        		else if(pos[i] > pos_max[i])
+        			dist2 += (pos[i] - pos_max[i]) * (pos[i] - pos_max[i]);
+        	}
+        	return dist2;
+        }
+
         void print() {
         	CGoGNout << "Boîte d'intéret : " << CGoGNendl;
         	CGoGNout << "  Min : X = " << m_pos_min[0] << " | Y = " << m_pos_min[1] << " | Z = " << m_pos_min[2] << CGoGNendl;
@@ -90,7 +134,9 @@ struct Box {
     private:
         PFP::VEC3 m_pos_min;    //Position [xmin;ymin;zmin]
         PFP::VEC3 m_pos_max;    //Position [xmax;ymax;zmax]
+#ifndef VDPMESH_HEADLESS
         Utils::Drawer* m_drawer;
+#endif
 };
 } //namespace VDPMesh
 } //namespace Surface
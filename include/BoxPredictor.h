@@ -0,0 +1,79 @@
+ #ifndef __BOX_PREDICTOR_H__
+ #define __BOX_PREDICTOR_H__
+
+#include <vector>
+#include <algorithm>
+
+#include "Node.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Prédiction du déplacement de la boîte d'intérêt à partir de ses dernières positions
+ * (centres). Le déplacement moyen n'est extrapolé que si le mouvement est régulier :
+ * chacun des derniers déplacements va dans le sens du déplacement moyen.
+ * Les positions sont relevées une fois par déplacement demandé, et une fois de plus
+ * lorsque la boîte est restée immobile REST_DELAY ms : ce déplacement nul met fin à
+ * la prédiction.
+ */
+class BoxPredictor {
+    public:
+        static const unsigned int HISTORY = 4;  //Nombre de déplacements retenus
+        static const unsigned int REST_DELAY = 500;  //Immobilité (ms) au-delà de laquelle la boîte est au repos
+
+        BoxPredictor() : m_lookAhead(0.0f) {}
+
+        //Nombre de déplacements moyens anticipés (0 : pas de prédiction)
+        float getLookAhead() const { return m_lookAhead; }
+        void setLookAhead(float steps) { m_lookAhead = steps; }
+
+        void clear() { m_centers.clear(); }
+
+        //Nouvelle position de la boîte (une position inchangée est un déplacement nul)
+        void record(const VEC3& pos_min, const VEC3& pos_max) {
+            VEC3 c = (pos_min + pos_max) * 0.5f;
+            if(m_centers.size() > HISTORY)
+                m_centers.erase(m_centers.begin());
+            m_centers.push_back(c);
+        }
+
+        /*
+         * Volume balayé par la boîte déplacée de 1 à getLookAhead() déplacements moyens.
+         * Faux si le mouvement n'est pas assez régulier pour être extrapolé.
+         */
+        bool predict(const VEC3& pos_min, const VEC3& pos_max, VEC3& pred_min, VEC3& pred_max) const {
+            if(m_lookAhead <= 0.0f || m_centers.size() < 3)
+                return false;
+            VEC3 v = (m_centers.back() - m_centers.front()) / float(m_centers.size() - 1);
+            if(v * v <= 0.0f)
+                return false;
+            for(unsigned int i = 1; i < m_centers.size(); ++i) {
+                if((m_centers[i] - m_centers[i - 1]) * v <= 0.0f)
+                    return false;
+            }
+            VEC3 first = v;
+            VEC3 last = v * std::max(1.0f, m_lookAhead);
+            for(unsigned int k = 0; k < 3; ++k) {
+                pred_min[k] = pos_min[k] + std::min(first[k], last[k]);
+                pred_max[k] = pos_max[k] + std::max(first[k], last[k]);
+            }
+            return true;
+        }
+
+    private:
+        std::vector<VEC3> m_centers;    //Dernières positions, de la plus ancienne à la plus récente
+        float m_lookAhead;
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
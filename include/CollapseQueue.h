@@ -0,0 +1,106 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __COLLAPSE_QUEUE_H__
+#define __COLLAPSE_QUEUE_H__
+
+#include <vector>
+#include <algorithm>
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * File de priorité des contractions d'arêtes à invalidation paresseuse.
+ * Tas binaire plat (un seul vecteur, aucune allocation par entrée) ordonné par
+ * (coût, brin). Chaque entrée porte le tampon de version de son arête au moment de
+ * l'insertion : une entrée dont le tampon ne correspond plus est périmée et doit
+ * être ignorée par l'appelant lorsqu'elle sort du tas, au lieu d'être retirée à
+ * l'avance.
+ */
+template <typename REAL>
+class CollapseQueue
+{
+public:
+	struct Entry
+	{
+		REAL cost ;
+		unsigned int stamp ;
+		Dart dart ;
+	} ;
+
+private:
+	/*Comparateur du tas : le plus petit coût est au sommet*/
+	struct Greater
+	{
+		bool operator()(const Entry& a, const Entry& b) const
+		{
+			if(a.cost != b.cost) return a.cost > b.cost ;
+			return a.dart.index > b.dart.index ;
+		}
+	} ;
+
+	std::vector<Entry> m_heap ;
+
+public:
+	void reserve(unsigned int n) { m_heap.reserve(n) ; }
+	void clear() { m_heap.clear() ; }
+
+	bool empty() const { return m_heap.empty() ; }
+	unsigned int size() const { return m_heap.size() ; }
+
+	void push(REAL cost, Dart d, unsigned int stamp)
+	{
+		Entry e ;
+		e.cost = cost ;
+		e.stamp = stamp ;
+		e.dart = d ;
+		m_heap.push_back(e) ;
+		std::push_heap(m_heap.begin(), m_heap.end(), Greater()) ;
+	}
+
+	const Entry& top() const { return m_heap.front() ; }
+
+	void pop()
+	{
+		std::pop_heap(m_heap.begin(), m_heap.end(), Greater()) ;
+		m_heap.pop_back() ;
+	}
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
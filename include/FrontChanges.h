@@ -0,0 +1,51 @@
+ #ifndef __FRONT_CHANGES_H__
+ #define __FRONT_CHANGES_H__
+
+#include <vector>
+
+#include "Node.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Changements du maillage notés par le maillage progressif depuis la dernière
+ * lecture : un brin de chaque face dont les sommets ou la présence ont pu changer
+ * (étoiles des sommets touchés par une transformation) et noeuds entrés dans le
+ * front ou sortis. Un même brin ou noeud peut figurer plusieurs fois.
+ * rebuild signale un changement global (construction, chargement de la hiérarchie)
+ * après lequel les tampons doivent être reconstruits en entier.
+ */
+struct FrontChanges {
+    std::vector<Dart> darts;
+    std::vector<unsigned int> nodes;
+    bool rebuild;
+
+    FrontChanges() : rebuild(false) {}
+
+    bool empty() const { return darts.empty() && nodes.empty() && !rebuild; }
+
+    void clear() {
+        darts.clear();
+        nodes.clear();
+        rebuild = false;
+    }
+
+    void requestRebuild() {
+        darts.clear();
+        nodes.clear();
+        rebuild = true;
+    }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,112 @@
+ #ifndef __FRONT_NORMALS_H__
+ #define __FRONT_NORMALS_H__
+
+#include <vector>
+
+#include "Node.h"
+#include "FrontChanges.h"
+
+#include "Algo/Geometry/normal.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Mise à jour des normales aux sommets à partir des changements notés par le maillage
+ * progressif (FrontChanges), à lire avant que FrontBuffers::apply() ne les efface.
+ * La normale d'un sommet ne change que si l'une de ses faces change : seuls les
+ * sommets des faces actives signalées sont revus, soit le 1-anneau de chaque
+ * transformation. Deux modes :
+ *  - recalcul sur les faces actives autour de ces sommets ;
+ *  - reprise telle quelle de la normale précalculée des noeuds entrés dans le front
+ *    (aucun parcours de la carte ; les voisins gardent leur normale).
+ * Les lignes d'attribut modifiées sont listées pour un transfert partiel.
+ */
+template <typename PFP>
+class FrontNormals {
+    public:
+        typedef typename PFP::MAP MAP;
+
+        FrontNormals() : m_currentStamp(0) {}
+
+        //Lignes d'attribut modifiées par la dernière mise à jour
+        const std::vector<unsigned int>& touched() const { return m_touched; }
+
+        size_t memory() const { return (m_touched.capacity() + m_stamp.capacity()) * sizeof(unsigned int); }
+
+        //Recalcul des normales des sommets des faces actives signalées
+        void update(MAP& map, DartMarker& inactive, const VertexAttribute<VEC3>& position,
+                    VertexAttribute<VEC3>& normal, const FrontChanges& changes) {
+            next();
+            for(unsigned int i = 0; i < changes.darts.size(); ++i) {
+                Dart d = changes.darts[i];
+                if(inactive.isMarked(d))
+                    continue;
+                Dart face[3] = { d, map.phi1(d), map.phi_1(d) };
+                for(unsigned int k = 0; k < 3; ++k) {
+                    unsigned int v = map.template getEmbedding<VERTEX>(face[k]);
+                    if(visit(v))
+                        normal[v] = Algo::Surface::Geometry::vertexNormal<PFP>(map, face[k], position);
+                }
+            }
+        }
+
+        //Normales précalculées des noeuds entrés dans le front
+        void update(const NodePool& nodes, const std::vector<VEC3>& nodeNormals,
+                    VertexAttribute<VEC3>& normal, const FrontChanges& changes) {
+            next();
+            for(unsigned int i = 0; i < changes.nodes.size(); ++i) {
+                unsigned int n = changes.nodes[i];
+                if(!nodes.isActive(n))
+                    continue;
+                unsigned int v = nodes.getVertex(n);
+                if(visit(v))
+                    normal[v] = nodeNormals[n];
+            }
+        }
+
+        //Normales précalculées de tout le front (reconstruction)
+        void assign(const NodePool& nodes, const std::vector<VEC3>& nodeNormals, VertexAttribute<VEC3>& normal) {
+            next();
+            for(unsigned int n = 0; n < nodes.size(); ++n) {
+                if(nodes.isActive(n)) {
+                    unsigned int v = nodes.getVertex(n);
+                    normal[v] = nodeNormals[n];
+                    m_touched.push_back(v);
+                }
+            }
+        }
+
+    private:
+        std::vector<unsigned int> m_touched;
+        std::vector<unsigned int> m_stamp;  //Dernière mise à jour ayant revu chaque ligne
+        unsigned int m_currentStamp;
+
+        void next() {
+            m_touched.clear();
+            ++m_currentStamp;
+        }
+
+        //Marque la ligne ; faux si elle l'était déjà pendant cette mise à jour
+        bool visit(unsigned int v) {
+            if(v >= m_stamp.size())
+                m_stamp.resize(v + 1, 0);
+            if(m_stamp[v] == m_currentStamp)
+                return false;
+            m_stamp[v] = m_currentStamp;
+            m_touched.push_back(v);
+            return true;
+        }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,196 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __FRONT_RENDER_H__
+#define __FRONT_RENDER_H__
+
+#include <cstring>
+#include <algorithm>
+
+#include "Utils/vbo.h"
+#include "Utils/GLSLShader.h"
+
+#include "FrontSnapshot.h"
+#include "IndexBuffers.h"
+#include "VertexCache.h"
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Affichage d'une copie du maillage (FrontSnapshot) ou de tableaux d'indices tenus
+ * à jour (FrontBuffers, dont seules les plages modifiées sont transférées) : tampons
+ * d'indices propres, les positions et normales étant lues dans les VBO de l'application.
+ * Equivalent de MapRender sans parcours de la carte, pour le thread graphique.
+ * A créer et utiliser avec le contexte OpenGL courant.
+ */
+class FrontRender
+{
+public:
+	enum { POINTS = 0, LINES = 1, TRIANGLES = 2 } ;
+
+	FrontRender()
+	{
+		glGenBuffers(3, m_indexBuffers) ;
+		for(unsigned int i = 0; i < 3; ++i)
+			m_nbIndices[i] = m_capacity[i] = 0 ;
+	}
+
+	~FrontRender()
+	{
+		glDeleteBuffers(3, m_indexBuffers) ;
+	}
+
+	void upload(const FrontSnapshot& s, Utils::VBO* normalVBO)
+	{
+		uploadIndices(POINTS, s.points) ;
+		uploadIndices(LINES, s.lines) ;
+		uploadIndices(TRIANGLES, s.triangles) ;
+
+		if(normalVBO && !s.normals.empty())
+		{
+			normalVBO->allocate(s.normals.size()) ;
+			void* ptr = normalVBO->lockPtr() ;
+			std::memcpy(ptr, &s.normals[0], s.normals.size() * sizeof(VEC3)) ;
+			normalVBO->releasePtr() ;
+		}
+	}
+
+	/*
+	 * Transfert des plages modifiées du tableau (PatchedIndexArray ou
+	 * CacheOrderedTriangles) ; tampon réalloué avec de la marge s'il est trop petit
+	 */
+	template <typename IndexArray>
+	void patch(int prim, IndexArray& a)
+	{
+		const std::vector<unsigned int>& indices = a.indices() ;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffers[prim]) ;
+		if(indices.size() > m_capacity[prim])
+		{
+			m_capacity[prim] = indices.size() + indices.size() / 2 ;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_capacity[prim] * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW) ;
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), &indices[0]) ;
+		}
+		else
+		{
+			a.dirtyRanges(m_ranges) ;
+			for(unsigned int i = 0; i < m_ranges.size(); ++i)
+				glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, m_ranges[i].first * sizeof(GLuint),
+				                (m_ranges[i].second - m_ranges[i].first) * sizeof(GLuint), &indices[m_ranges[i].first]) ;
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) ;
+		m_nbIndices[prim] = indices.size() ;
+		a.clearDirty() ;
+	}
+
+	/*
+	 * Les triangles sont pris dans le flux ordonné pour le cache s'il est donné (mis à
+	 * jour au préalable depuis buffers.triangles)
+	 */
+	void patch(FrontBuffers<PFP>& buffers, CacheOrderedTriangles<PFP>* ordered = NULL)
+	{
+		patch(POINTS, buffers.points) ;
+		patch(LINES, buffers.lines) ;
+		if(ordered)
+		{
+			patch(TRIANGLES, *ordered) ;
+			buffers.triangles.clearDirty() ;
+		}
+		else
+			patch(TRIANGLES, buffers.triangles) ;
+	}
+
+	/*
+	 * Transfert des normales des seules lignes d'attribut listées (FrontNormals),
+	 * regroupées en plages ; le VBO doit déjà contenir toutes les lignes
+	 */
+	void patchNormals(Utils::VBO* normalVBO, const VertexAttribute<VEC3>& normal,
+	                  const std::vector<unsigned int>& lines, unsigned int maxGap = 16)
+	{
+		if(lines.empty())
+			return ;
+		m_lines.assign(lines.begin(), lines.end()) ;
+		std::sort(m_lines.begin(), m_lines.end()) ;
+		normalVBO->bind() ;
+		unsigned int i = 0 ;
+		while(i < m_lines.size())
+		{
+			//Plage [first ; last] : lignes proches fusionnées (les lignes intermédiaires sont recopiées)
+			unsigned int first = m_lines[i] ;
+			unsigned int last = first ;
+			while(++i < m_lines.size() && m_lines[i] <= last + maxGap)
+				last = m_lines[i] ;
+			m_staging.resize(last - first + 1) ;
+			for(unsigned int l = first; l <= last; ++l)
+				m_staging[l - first] = normal[l] ;
+			glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(VEC3), m_staging.size() * sizeof(VEC3), &m_staging[0]) ;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0) ;
+	}
+
+	void draw(Utils::GLSLShader* sh, int prim)
+	{
+		if(m_nbIndices[prim] == 0)
+			return ;
+		static const GLenum modes[3] = { GL_POINTS, GL_LINES, GL_TRIANGLES } ;
+		sh->enableVertexAttribs() ;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffers[prim]) ;
+		glDrawElements(modes[prim], m_nbIndices[prim], GL_UNSIGNED_INT, 0) ;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) ;
+		sh->disableVertexAttribs() ;
+	}
+
+private:
+	GLuint m_indexBuffers[3] ;
+	GLsizei m_nbIndices[3] ;
+	unsigned int m_capacity[3] ;     //Taille des tampons alloués (indices)
+	std::vector<std::pair<unsigned int, unsigned int> > m_ranges ;
+	std::vector<unsigned int> m_lines ;
+	std::vector<VEC3> m_staging ;
+
+	void uploadIndices(int prim, const std::vector<unsigned int>& indices)
+	{
+		m_nbIndices[prim] = indices.size() ;
+		m_capacity[prim] = indices.size() ;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffers[prim]) ;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.empty() ? NULL : &indices[0], GL_STREAM_DRAW) ;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) ;
+	}
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,44 @@
+ #ifndef __FRONT_SNAPSHOT_H__
+ #define __FRONT_SNAPSHOT_H__
+
+#include <vector>
+
+#include "Node.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Copie du maillage courant (faces actives) pour l'affichage : indices de sommets
+ * (lignes d'attribut) des triangles, arêtes et sommets, et normales aux sommets.
+ * Tenue à jour par le thread qui modifie la carte (RefinementWorker), elle est
+ * ensuite lue sans accès à la carte.
+ */
+struct FrontSnapshot {
+    std::vector<unsigned int> triangles;
+    std::vector<unsigned int> lines;
+    std::vector<unsigned int> points;
+    std::vector<VEC3> normals;  //Indexées par ligne d'attribut de sommet
+    unsigned int generation;    //Numéro de la mise à jour qui l'a produite
+
+    FrontSnapshot() : generation(0) {}
+
+    void clear() {
+        triangles.clear();
+        lines.clear();
+        points.clear();
+        normals.clear();
+    }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,311 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __HIERARCHY_CACHE_H__
+#define __HIERARCHY_CACHE_H__
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <fstream>
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Format du cache de hiérarchie (fichier .vdpm) :
+ *   CacheHeader | NodeRecord[nbNodes] | unsigned int inactiveDarts[nbInactiveDarts]
+ *   | lignes utilisées des brins, sommets et arêtes (un bit par ligne)
+ * La carte contractée elle-même est enregistrée à côté (fichier .vdpm.map, format
+ * binaire CGoGN) ; sa taille est reportée dans l'en-tête pour détecter une paire
+ * de fichiers incohérente. Les lignes utilisées permettent de valider les indices
+ * des noeuds avant de charger la carte, qui n'est lue qu'une fois.
+ */
+const char CACHE_MAGIC[8] = { 'V', 'D', 'P', 'M', 'C', 'A', 'C', 'H' } ;
+const unsigned int CACHE_VERSION = 5 ;
+const unsigned int CACHE_NONE = 0xffffffff ;   //Indice de noeud absent
+
+struct CacheHeader
+{
+	char magic[8] ;
+	unsigned int version ;
+	unsigned int headerSize ;
+	unsigned long long key ;        //Empreinte du maillage d'entrée et des paramètres
+	unsigned long long mapSize ;    //Taille du fichier .map associé
+	unsigned long long positionName ;   //Empreinte du nom de l'attribut des positions
+	unsigned int nbNodes ;
+	unsigned int nbInactiveDarts ;
+	int height ;
+	unsigned int dartLines ;        //Tailles (realEnd) des conteneurs de la carte
+	unsigned int vertexLines ;
+	unsigned int edgeLines ;
+} ;
+
+struct NodeRecord
+{
+	unsigned int parent ;
+	unsigned int leftChild ;
+	unsigned int rightChild ;
+	unsigned int vertex ;
+	int height ;
+	unsigned int active ;
+	/*VSplit : brins et lignes d'approximation (CACHE_NONE pour une feuille)*/
+	unsigned int edge ;
+	unsigned int rightEdge ;
+	unsigned int leftEdge ;
+	unsigned int approxV ;
+	unsigned int approxE1 ;
+	unsigned int approxE2 ;
+	/*Cône des normales (calculé sur le maillage complet, perdu une fois contracté)*/
+	float coneAxis[3] ;
+	float coneAngle ;
+	/*Normale du sommet sur le maillage où le noeud apparaît*/
+	float normal[3] ;
+} ;
+
+/*
+ * Lignes utilisées d'un conteneur de la carte enregistrée, un bit par ligne
+ */
+inline unsigned int usedLinesWords(unsigned int nbLines)
+{
+	return (nbLines + 31) / 32 ;
+}
+
+template <typename Container>
+inline void appendUsedLines(const Container& cont, std::vector<unsigned int>& words)
+{
+	size_t first = words.size() ;
+	words.resize(first + usedLinesWords(cont.realEnd()), 0) ;
+	for(unsigned int line = 0 ; line < cont.realEnd() ; ++line)
+	{
+		if(cont.used(line))
+			words[first + (line >> 5)] |= 1u << (line & 31) ;
+	}
+}
+
+struct UsedLines
+{
+	const unsigned int* words ;
+	unsigned int nbLines ;
+
+	UsedLines(const unsigned int* w, unsigned int n) : words(w), nbLines(n) {}
+
+	bool contains(unsigned int line) const
+	{
+		return line < nbLines && ((words[line >> 5] >> (line & 31)) & 1) ;
+	}
+} ;
+
+/*
+ * Empreinte FNV-1a 64 bits, chaînable via la valeur initiale
+ */
+const unsigned long long FNV_OFFSET = 14695981039346656037ULL ;
+
+inline unsigned long long fnv1a(const void* data, size_t size, unsigned long long h = FNV_OFFSET)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data) ;
+	for(size_t i = 0 ; i < size ; ++i)
+	{
+		h ^= p[i] ;
+		h *= 1099511628211ULL ;
+	}
+	return h ;
+}
+
+template <typename T>
+inline unsigned long long fnv1aValue(const T& value, unsigned long long h)
+{
+	return fnv1a(&value, sizeof(T), h) ;
+}
+
+inline long long fileSize(const std::string& filename)
+{
+	std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate) ;
+	if(!in.good())
+		return -1 ;
+	return (long long)in.tellg() ;
+}
+
+/*
+ * Pic de mémoire résidente du processus, en octets (0 s'il n'est pas connu)
+ */
+inline size_t peakMemory()
+{
+#ifndef WIN32
+	struct rusage usage ;
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0 ;
+#ifdef __APPLE__
+	return size_t(usage.ru_maxrss) ;
+#else
+	return size_t(usage.ru_maxrss) * 1024 ;
+#endif
+#else
+	return 0 ;
+#endif
+}
+
+/*
+ * Fichier projeté en mémoire (lecture complète sous Windows)
+ */
+class MappedFile
+{
+public:
+	MappedFile() : m_data(NULL), m_size(0) {}
+	~MappedFile() { close() ; }
+
+	bool open(const std::string& filename)
+	{
+		close() ;
+#ifndef WIN32
+		int fd = ::open(filename.c_str(), O_RDONLY) ;
+		if(fd < 0)
+			return false ;
+		struct stat st ;
+		if(fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			::close(fd) ;
+			return false ;
+		}
+		void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+		::close(fd) ;
+		if(p == MAP_FAILED)
+			return false ;
+		m_data = static_cast<char*>(p) ;
+		m_size = st.st_size ;
+#else
+		std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate) ;
+		if(!in.good())
+			return false ;
+		m_buffer.resize((size_t)in.tellg()) ;
+		in.seekg(0) ;
+		in.read(&m_buffer[0], m_buffer.size()) ;
+		m_data = m_buffer.empty() ? NULL : &m_buffer[0] ;
+		m_size = m_buffer.size() ;
+#endif
+		return m_data != NULL ;
+	}
+
+	/*
+	 * Crée (ou écrase) un fichier de taille donnée, rempli de zéros et projeté en
+	 * lecture/écriture : les modifications sont reportées dans le fichier
+	 */
+	bool create(const std::string& filename, size_t size)
+	{
+		close() ;
+		if(size == 0)
+			return false ;
+#ifndef WIN32
+		int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) ;
+		if(fd < 0)
+			return false ;
+		if(ftruncate(fd, size) != 0)
+		{
+			::close(fd) ;
+			return false ;
+		}
+		void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) ;
+		::close(fd) ;
+		if(p == MAP_FAILED)
+			return false ;
+		m_data = static_cast<char*>(p) ;
+#else
+		m_buffer.assign(size, 0) ;
+		m_data = &m_buffer[0] ;
+		m_writeBack = filename ;
+#endif
+		m_size = size ;
+		return true ;
+	}
+
+	void close()
+	{
+#ifndef WIN32
+		if(m_data)
+			munmap(m_data, m_size) ;
+#else
+		if(!m_writeBack.empty() && !m_buffer.empty())
+		{
+			std::ofstream out(m_writeBack.c_str(), std::ios::binary) ;
+			out.write(&m_buffer[0], m_buffer.size()) ;
+		}
+		m_writeBack.clear() ;
+		m_buffer.clear() ;
+#endif
+		m_data = NULL ;
+		m_size = 0 ;
+	}
+
+	const char* data() const { return m_data ; }
+	char* writableData() { return m_data ; }
+	size_t size() const { return m_size ; }
+
+private:
+	char* m_data ;
+	size_t m_size ;
+#ifdef WIN32
+	std::vector<char> m_buffer ;
+	std::string m_writeBack ;
+#endif
+
+	MappedFile(const MappedFile&) ;
+	MappedFile& operator=(const MappedFile&) ;
+} ;
+
+/*
+ * Empreinte du contenu d'un fichier de maillage
+ */
+inline unsigned long long hashFile(const std::string& filename)
+{
+	MappedFile f ;
+	if(!f.open(filename))
+		return 0 ;
+	return fnv1a(f.data(), f.size()) ;
+}
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
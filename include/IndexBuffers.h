@@ -0,0 +1,334 @@
+ #ifndef __INDEX_BUFFERS_H__
+ #define __INDEX_BUFFERS_H__
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "Node.h"
+#include "FrontChanges.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Tableau d'indices de primitives (arity indices par primitive) tenu à jour par
+ * modifications ponctuelles. Chaque primitive est désignée par une clé (brin, noeud)
+ * et occupe une place fixe dans le tableau :
+ *  - mode à trous (triangles, arêtes) : une primitive retirée est remplacée par une
+ *    primitive dégénérée (indices tous égaux, rien n'est tracé) et sa place est
+ *    réutilisée par la suivante ajoutée ; compact() resserre le tableau de temps en temps ;
+ *  - mode dense (sommets, qu'aucune primitive dégénérée ne cache) : la dernière
+ *    primitive prend la place de celle retirée.
+ * Les places modifiées sont notées pour ne transférer que les plages touchées.
+ */
+class PatchedIndexArray {
+    public:
+        PatchedIndexArray(unsigned int arity, bool dense = false) : m_arity(arity), m_dense(dense), m_resized(false) {}
+
+        unsigned int arity() const { return m_arity; }
+        unsigned int nbSlots() const { return m_keyOf.size(); }
+        unsigned int nbFree() const { return m_free.size(); }
+        unsigned int nbPrimitives() const { return m_keyOf.size() - m_free.size(); }
+        const std::vector<unsigned int>& indices() const { return m_indices; }
+        size_t memory() const {
+            return (m_indices.capacity() + m_slotOf.capacity() + m_keyOf.capacity() + m_free.capacity() + m_dirty.capacity()) * sizeof(unsigned int)
+                + m_dirtyFlag.capacity() * sizeof(unsigned char);
+        }
+
+        void clear() {
+            m_indices.clear();
+            m_slotOf.clear();
+            m_keyOf.clear();
+            m_free.clear();
+            m_dirty.clear();
+            m_dirtyFlag.clear();
+            m_resized = true;
+        }
+
+        bool contains(unsigned int key) const { return key < m_slotOf.size() && m_slotOf[key] != NO_SLOT; }
+        bool isUsed(unsigned int slot) const { return m_keyOf[slot] != NO_NODE; }
+
+        //Ajoute ou met à jour la primitive key (v : arity indices)
+        void set(unsigned int key, const unsigned int* v) {
+            if(key >= m_slotOf.size())
+                m_slotOf.resize(key + 1, NO_SLOT);
+            unsigned int slot = m_slotOf[key];
+            if(slot == NO_SLOT) {
+                slot = allocate();
+                m_slotOf[key] = slot;
+                m_keyOf[slot] = key;
+            }
+            else if(std::equal(v, v + m_arity, m_indices.begin() + slot * m_arity))
+                return;
+            std::copy(v, v + m_arity, m_indices.begin() + slot * m_arity);
+            markDirty(slot);
+        }
+
+        void remove(unsigned int key) {
+            if(!contains(key))
+                return;
+            unsigned int slot = m_slotOf[key];
+            m_slotOf[key] = NO_SLOT;
+            if(m_dense) {
+                unsigned int last = m_keyOf.size() - 1;
+                if(slot != last) {
+                    std::copy(m_indices.begin() + last * m_arity, m_indices.begin() + (last + 1) * m_arity, m_indices.begin() + slot * m_arity);
+                    m_keyOf[slot] = m_keyOf[last];
+                    m_slotOf[m_keyOf[slot]] = slot;
+                    markDirty(slot);
+                }
+                m_keyOf.pop_back();
+                m_indices.resize(last * m_arity);
+                m_resized = true;
+                return;
+            }
+            //Primitive dégénérée : tous ses indices valent le premier
+            std::fill(m_indices.begin() + slot * m_arity + 1, m_indices.begin() + (slot + 1) * m_arity, m_indices[slot * m_arity]);
+            m_keyOf[slot] = NO_NODE;
+            m_free.push_back(slot);
+            markDirty(slot);
+        }
+
+        /*
+         * Déplace les dernières primitives dans les trous (mode à trous) si ceux-ci
+         * dépassent la proportion maxFreeRatio. Renvoie vrai si le tableau a été resserré.
+         */
+        bool compact(float maxFreeRatio = 0.25f) {
+            if(m_dense || m_free.empty() || float(m_free.size()) <= maxFreeRatio * float(m_keyOf.size()))
+                return false;
+            std::sort(m_free.begin(), m_free.end());
+            unsigned int size = m_keyOf.size();
+            unsigned int f = 0;
+            while(f < m_free.size() && m_free[f] < size) {
+                //Retire les places libres en fin de tableau
+                if(m_keyOf[size - 1] == NO_NODE) {
+                    --size;
+                    continue;
+                }
+                unsigned int slot = m_free[f++];
+                unsigned int last = size - 1;
+                std::copy(m_indices.begin() + last * m_arity, m_indices.begin() + size * m_arity, m_indices.begin() + slot * m_arity);
+                m_keyOf[slot] = m_keyOf[last];
+                m_slotOf[m_keyOf[slot]] = slot;
+                markDirty(slot);
+                --size;
+            }
+            m_keyOf.resize(size);
+            m_indices.resize(size * m_arity);
+            m_free.clear();
+            m_resized = true;
+            return true;
+        }
+
+        /*Plages modifiées depuis clearDirty()*/
+
+        //Vrai si la taille a changé (le tampon doit être retransféré en entier s'il est trop petit)
+        bool resized() const { return m_resized; }
+        bool hasDirty() const { return !m_dirty.empty() || m_resized; }
+        //Places modifiées (éventuellement au-delà de nbSlots() après un resserrement)
+        const std::vector<unsigned int>& dirtySlots() const { return m_dirty; }
+
+        //Plages [début ; fin[ d'indices modifiés, fusionnées si moins de maxGap primitives les séparent
+        void dirtyRanges(std::vector<std::pair<unsigned int, unsigned int> >& ranges, unsigned int maxGap = 64) {
+            ranges.clear();
+            std::sort(m_dirty.begin(), m_dirty.end());
+            for(unsigned int i = 0; i < m_dirty.size(); ++i) {
+                unsigned int slot = m_dirty[i];
+                if(slot >= m_keyOf.size())
+                    continue;   //Place supprimée depuis
+                if(!ranges.empty() && slot * m_arity <= ranges.back().second + maxGap * m_arity)
+                    ranges.back().second = (slot + 1) * m_arity;
+                else
+                    ranges.push_back(std::make_pair(slot * m_arity, (slot + 1) * m_arity));
+            }
+        }
+
+        void clearDirty() {
+            for(unsigned int i = 0; i < m_dirty.size(); ++i) {
+                if(m_dirty[i] < m_dirtyFlag.size())
+                    m_dirtyFlag[m_dirty[i]] = 0;
+            }
+            m_dirty.clear();
+            m_resized = false;
+        }
+
+    private:
+        unsigned int m_arity;
+        bool m_dense;
+        std::vector<unsigned int> m_indices;
+        std::vector<unsigned int> m_slotOf;     //Clé -> place (NO_SLOT si absente)
+        std::vector<unsigned int> m_keyOf;      //Place -> clé (NO_NODE si libre)
+        std::vector<unsigned int> m_free;       //Places libres (mode à trous)
+        std::vector<unsigned int> m_dirty;      //Places modifiées
+        std::vector<unsigned char> m_dirtyFlag;
+        bool m_resized;
+
+        unsigned int allocate() {
+            if(!m_free.empty()) {
+                unsigned int slot = m_free.back();
+                m_free.pop_back();
+                return slot;
+            }
+            m_keyOf.push_back(NO_NODE);
+            m_indices.resize(m_keyOf.size() * m_arity, 0);
+            m_resized = true;
+            return m_keyOf.size() - 1;
+        }
+
+        void markDirty(unsigned int slot) {
+            if(slot >= m_dirtyFlag.size())
+                m_dirtyFlag.resize(slot + 1, 0);
+            if(!m_dirtyFlag[slot]) {
+                m_dirtyFlag[slot] = 1;
+                m_dirty.push_back(slot);
+            }
+        }
+};
+
+/*
+ * Tableaux d'indices de l'affichage (triangles, arêtes, sommets) du maillage courant,
+ * mis à jour à partir des changements notés par le maillage progressif : seules les
+ * faces et arêtes des brins signalés et les sommets des noeuds entrés ou sortis du
+ * front sont revus, si bien que le coût d'une mise à jour suit le nombre de
+ * transformations et non la taille du modèle.
+ * Clés : plus petit brin de la face pour un triangle, plus petit des deux brins pour
+ * une arête, noeud pour un sommet.
+ */
+template <typename PFP>
+class FrontBuffers {
+    public:
+        typedef typename PFP::MAP MAP;
+
+        FrontBuffers() : triangles(3), lines(2), points(1, true), m_currentStamp(0) {}
+
+        PatchedIndexArray triangles;
+        PatchedIndexArray lines;
+        PatchedIndexArray points;
+
+        size_t memory() const { return triangles.memory() + lines.memory() + points.memory() + m_stamp.capacity() * sizeof(unsigned int); }
+
+        //Construction complète depuis la carte et les noeuds actifs
+        void build(MAP& map, DartMarker& inactive, const NodePool& nodes) {
+            triangles.clear();
+            lines.clear();
+            points.clear();
+            for(Dart d = map.begin(); d != map.end(); map.next(d)) {
+                if(inactive.isMarked(d))
+                    continue;
+                if(d.index == faceKey(map, d))
+                    setFace(map, d);
+                Dart p = map.phi2(d);
+                if(inactive.isMarked(p) || d.index < p.index)
+                    setEdge(map, d);
+            }
+            for(unsigned int n = 0; n < nodes.size(); ++n) {
+                if(nodes.isActive(n)) {
+                    unsigned int v = nodes.getVertex(n);
+                    points.set(n, &v);
+                }
+            }
+        }
+
+        //Applique les changements notés depuis la dernière lecture, puis les efface
+        void apply(MAP& map, DartMarker& inactive, const NodePool& nodes, FrontChanges& changes) {
+            if(changes.rebuild) {
+                build(map, inactive, nodes);
+                changes.clear();
+                return;
+            }
+            ++m_currentStamp;
+            for(unsigned int i = 0; i < changes.darts.size(); ++i) {
+                Dart d = changes.darts[i];
+                Dart face[3] = { d, map.phi1(d), map.phi_1(d) };
+                unsigned int key = std::min(face[0].index, std::min(face[1].index, face[2].index));
+                if(!visit(key))
+                    continue;
+                if(inactive.isMarked(d))
+                    triangles.remove(key);
+                else
+                    setFace(map, d);
+                for(unsigned int k = 0; k < 3; ++k)
+                    updateEdge(map, inactive, face[k]);
+            }
+            for(unsigned int i = 0; i < changes.nodes.size(); ++i) {
+                unsigned int n = changes.nodes[i];
+                if(nodes.isActive(n)) {
+                    unsigned int v = nodes.getVertex(n);
+                    points.set(n, &v);
+                }
+                else
+                    points.remove(n);
+            }
+            changes.clear();
+            triangles.compact();
+            lines.compact();
+        }
+
+        void clearDirty() {
+            triangles.clearDirty();
+            lines.clearDirty();
+            points.clearDirty();
+        }
+
+    private:
+        std::vector<unsigned int> m_stamp;  //Dernier passage de apply() sur chaque face
+        unsigned int m_currentStamp;
+
+        //Marque la face ; faux si elle l'était déjà pendant ce passage
+        bool visit(unsigned int key) {
+            if(key >= m_stamp.size())
+                m_stamp.resize(key + 1, 0);
+            if(m_stamp[key] == m_currentStamp)
+                return false;
+            m_stamp[key] = m_currentStamp;
+            return true;
+        }
+
+        unsigned int faceKey(MAP& map, Dart d) {
+            return std::min(d.index, std::min(map.phi1(d).index, map.phi_1(d).index));
+        }
+
+        void setFace(MAP& map, Dart d) {
+            unsigned int v[3] = {
+                map.template getEmbedding<VERTEX>(d),
+                map.template getEmbedding<VERTEX>(map.phi1(d)),
+                map.template getEmbedding<VERTEX>(map.phi_1(d))
+            };
+            triangles.set(faceKey(map, d), v);
+        }
+
+        void setEdge(MAP& map, Dart d) {
+            unsigned int v[2] = { map.template getEmbedding<VERTEX>(d), map.template getEmbedding<VERTEX>(map.phi1(d)) };
+            lines.set(d.index, v);
+        }
+
+        //L'arête est portée par le plus petit de ses deux brins actifs
+        void updateEdge(MAP& map, DartMarker& inactive, Dart d) {
+            if(inactive.isMarked(d)) {
+                lines.remove(d.index);
+                return;
+            }
+            Dart p = map.phi2(d);
+            if(inactive.isMarked(p) || d.index < p.index) {
+                setEdge(map, d);
+                lines.remove(p.index);
+            }
+            else {
+                setEdge(map, p);
+                lines.remove(d.index);
+            }
+        }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,299 @@
+ #ifndef __INTEREST_REGIONS_H__
+ #define __INTEREST_REGIONS_H__
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "Node.h"
+#include "Box.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+const unsigned int NO_REGION = 0xffffffff;    //Poignée de région absente
+
+/*
+ * Région d'intérêt : boîte alignée ou sphère. pos_min / pos_max est la boîte elle-même
+ * ou la boîte englobante de la sphère.
+ */
+struct InterestRegion {
+    enum Shape { BOX, SPHERE };
+
+    Shape shape;
+    VEC3 pos_min, pos_max;
+    VEC3 center;
+    float radius;
+
+    bool contains(const VEC3& p) const {
+        if(shape == SPHERE)
+            return (p - center).norm2() <= radius * radius;
+        return  pos_min[0] <= p[0] && p[0] <= pos_max[0]
+            &&  pos_min[1] <= p[1] && p[1] <= pos_max[1]
+            &&  pos_min[2] <= p[2] && p[2] <= pos_max[2];
+    }
+
+    //Distance d'un point à la région (0 à l'intérieur)
+    float distance(const VEC3& p) const {
+        if(shape == SPHERE)
+            return std::max(0.0f, (p - center).norm() - radius);
+        return std::sqrt(Box::distance2(pos_min, pos_max, p));
+    }
+};
+
+/*
+ * Ensemble dynamique de régions d'intérêt désignées par des poignées stables.
+ * Les régions sont rangées dans une grille régulière couvrant le modèle : chaque case
+ * liste les régions qui la touchent, si bien que le classement d'un point ne teste que
+ * les régions de sa case. Les points et régions hors de la grille sont ramenés à ses
+ * cases de bord. Une région couvrant plus de LARGE_CELLS cases n'est pas répartie dans
+ * la grille mais testée à chaque requête (au plus quelques régions de cette taille).
+ */
+class InterestRegions {
+    public:
+        static const unsigned int LARGE_CELLS = 512;
+
+        InterestRegions() : m_origin(0.0f, 0.0f, 0.0f), m_cellSize(1.0f, 1.0f, 1.0f), m_resolution(1), m_count(0) {
+            m_cells.resize(1);
+        }
+
+        /*Grille de resolution^3 cases sur [pos_min ; pos_max] (les régions existantes sont conservées)*/
+        void setGrid(const VEC3& pos_min, const VEC3& pos_max, unsigned int resolution = 16) {
+            m_origin = pos_min;
+            m_resolution = std::max(resolution, 1u);
+            for(unsigned int k = 0; k < 3; ++k) {
+                float extent = pos_max[k] - pos_min[k];
+                m_cellSize[k] = extent > 0.0f ? extent / float(m_resolution) : 1.0f;
+            }
+            m_cells.assign(m_resolution * m_resolution * m_resolution, std::vector<unsigned int>());
+            m_large.clear();
+            for(unsigned int h = 0; h < m_regions.size(); ++h) {
+                if(m_used[h])
+                    link(h);
+            }
+        }
+
+        unsigned int size() const { return m_count; }
+        bool empty() const { return m_count == 0; }
+        bool isValid(unsigned int h) const { return h < m_regions.size() && m_used[h]; }
+        const InterestRegion& get(unsigned int h) const { return m_regions[h]; }
+
+        void clear() {
+            m_regions.clear();
+            m_used.clear();
+            m_free.clear();
+            for(unsigned int i = 0; i < m_cells.size(); ++i)
+                m_cells[i].clear();
+            m_large.clear();
+            m_count = 0;
+        }
+
+        unsigned int addBox(const VEC3& pos_min, const VEC3& pos_max) {
+            InterestRegion r;
+            r.shape = InterestRegion::BOX;
+            r.pos_min = pos_min;
+            r.pos_max = pos_max;
+            r.center = (pos_min + pos_max) * 0.5f;
+            r.radius = (pos_max - pos_min).norm() * 0.5f;
+            return add(r);
+        }
+
+        unsigned int addSphere(const VEC3& center, float radius) {
+            return add(sphere(center, radius));
+        }
+
+        //Les opérations sur une poignée invalide (déjà retirée) sont sans effet
+        void moveBox(unsigned int h, const VEC3& pos_min, const VEC3& pos_max) {
+            if(!isValid(h))
+                return;
+            unlink(h);
+            InterestRegion& r = m_regions[h];
+            r.shape = InterestRegion::BOX;
+            r.pos_min = pos_min;
+            r.pos_max = pos_max;
+            r.center = (pos_min + pos_max) * 0.5f;
+            r.radius = (pos_max - pos_min).norm() * 0.5f;
+            link(h);
+        }
+
+        void moveSphere(unsigned int h, const VEC3& center, float radius) {
+            if(!isValid(h))
+                return;
+            unlink(h);
+            m_regions[h] = sphere(center, radius);
+            link(h);
+        }
+
+        void remove(unsigned int h) {
+            if(!isValid(h))
+                return;
+            unlink(h);
+            m_used[h] = false;
+            m_free.push_back(h);
+            --m_count;
+        }
+
+        //Vrai si le point est dans au moins une région
+        bool contains(const VEC3& p) const {
+            if(m_count == 0)
+                return false;
+            const std::vector<unsigned int>& cell = m_cells[cellIndex(p)];
+            for(unsigned int i = 0; i < cell.size(); ++i) {
+                if(m_regions[cell[i]].contains(p))
+                    return true;
+            }
+            for(unsigned int i = 0; i < m_large.size(); ++i) {
+                if(m_regions[m_large[i]].contains(p))
+                    return true;
+            }
+            return false;
+        }
+
+        //Distance du point à la région la plus proche, bornée par maxDistance
+        float distance(const VEC3& p, float maxDistance) const {
+            float res = maxDistance;
+            if(m_count == 0)
+                return res;
+            for(unsigned int i = 0; i < m_large.size(); ++i)
+                res = std::min(res, m_regions[m_large[i]].distance(p));
+            VEC3 r(maxDistance, maxDistance, maxDistance);
+            unsigned int lo[3], hi[3];
+            cellRange(p - r, p + r, lo, hi);
+            if((hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1) > m_count) {
+                for(unsigned int h = 0; h < m_regions.size(); ++h) {
+                    if(m_used[h])
+                        res = std::min(res, m_regions[h].distance(p));
+                }
+                return res;
+            }
+            //Les régions à moins de maxDistance touchent une case de [p - maxDistance ; p + maxDistance]
+            for(unsigned int z = lo[2]; z <= hi[2]; ++z) {
+                for(unsigned int y = lo[1]; y <= hi[1]; ++y) {
+                    for(unsigned int x = lo[0]; x <= hi[0]; ++x) {
+                        const std::vector<unsigned int>& cell = m_cells[(z * m_resolution + y) * m_resolution + x];
+                        for(unsigned int i = 0; i < cell.size(); ++i)
+                            res = std::min(res, m_regions[cell[i]].distance(p));
+                    }
+                }
+            }
+            return res;
+        }
+
+        size_t memory() const {
+            size_t res = m_regions.capacity() * sizeof(InterestRegion)
+                       + m_cells.capacity() * sizeof(std::vector<unsigned int>) + m_large.capacity() * sizeof(unsigned int);
+            for(unsigned int i = 0; i < m_cells.size(); ++i)
+                res += m_cells[i].capacity() * sizeof(unsigned int);
+            return res;
+        }
+
+    private:
+        std::vector<InterestRegion> m_regions;      //Indicées par poignée
+        std::vector<bool> m_used;
+        std::vector<unsigned int> m_free;           //Poignées libérées, réutilisées
+        std::vector<std::vector<unsigned int> > m_cells;
+        std::vector<unsigned int> m_large;          //Régions hors grille (trop étendues)
+        VEC3 m_origin;
+        VEC3 m_cellSize;
+        unsigned int m_resolution;
+        unsigned int m_count;
+
+        static InterestRegion sphere(const VEC3& center, float radius) {
+            InterestRegion r;
+            r.shape = InterestRegion::SPHERE;
+            r.center = center;
+            r.radius = radius;
+            VEC3 e(radius, radius, radius);
+            r.pos_min = center - e;
+            r.pos_max = center + e;
+            return r;
+        }
+
+        unsigned int add(const InterestRegion& r) {
+            unsigned int h;
+            if(!m_free.empty()) {
+                h = m_free.back();
+                m_free.pop_back();
+                m_regions[h] = r;
+                m_used[h] = true;
+            }
+            else {
+                h = m_regions.size();
+                m_regions.push_back(r);
+                m_used.push_back(true);
+            }
+            ++m_count;
+            link(h);
+            return h;
+        }
+
+        unsigned int cellCoord(float v, unsigned int k) const {
+            float c = std::floor((v - m_origin[k]) / m_cellSize[k]);
+            if(!(c > 0.0f))
+                return 0;
+            if(c >= float(m_resolution - 1))
+                return m_resolution - 1;
+            return (unsigned int)c;
+        }
+
+        unsigned int cellIndex(const VEC3& p) const {
+            return (cellCoord(p[2], 2) * m_resolution + cellCoord(p[1], 1)) * m_resolution + cellCoord(p[0], 0);
+        }
+
+        void cellRange(const VEC3& pos_min, const VEC3& pos_max, unsigned int* lo, unsigned int* hi) const {
+            for(unsigned int k = 0; k < 3; ++k) {
+                lo[k] = cellCoord(pos_min[k], k);
+                hi[k] = cellCoord(pos_max[k], k);
+            }
+        }
+
+        bool isLarge(const unsigned int* lo, const unsigned int* hi) const {
+            return (hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1) > LARGE_CELLS;
+        }
+
+        void link(unsigned int h) {
+            unsigned int lo[3], hi[3];
+            cellRange(m_regions[h].pos_min, m_regions[h].pos_max, lo, hi);
+            if(isLarge(lo, hi)) {
+                m_large.push_back(h);
+                return;
+            }
+            for(unsigned int z = lo[2]; z <= hi[2]; ++z)
+                for(unsigned int y = lo[1]; y <= hi[1]; ++y)
+                    for(unsigned int x = lo[0]; x <= hi[0]; ++x)
+                        m_cells[(z * m_resolution + y) * m_resolution + x].push_back(h);
+        }
+
+        static void erase(std::vector<unsigned int>& v, unsigned int h) {
+            std::vector<unsigned int>::iterator it = std::find(v.begin(), v.end(), h);
+            if(it != v.end()) {
+                *it = v.back();
+                v.pop_back();
+            }
+        }
+
+        void unlink(unsigned int h) {
+            unsigned int lo[3], hi[3];
+            cellRange(m_regions[h].pos_min, m_regions[h].pos_max, lo, hi);
+            if(isLarge(lo, hi)) {
+                erase(m_large, h);
+                return;
+            }
+            for(unsigned int z = lo[2]; z <= hi[2]; ++z)
+                for(unsigned int y = lo[1]; y <= hi[1]; ++y)
+                    for(unsigned int x = lo[0]; x <= hi[0]; ++x)
+                        erase(m_cells[(z * m_resolution + y) * m_resolution + x], h);
+        }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
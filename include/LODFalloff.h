@@ -0,0 +1,71 @@
+ #ifndef __LOD_FALLOFF_H__
+ #define __LOD_FALLOFF_H__
+
+#include <vector>
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Politiques de décroissance du niveau de détail pour le raffinement gradué : l'erreur
+ * géométrique tolérée pour un noeud croît avec sa distance aux régions d'intérêt.
+ * Une politique est un paramètre template du critère (appel résolu à la compilation)
+ * et fournit :
+ *   float maxDistance() const : distance à partir de laquelle la tolérance ne change plus
+ *   float allowedError(float d) const : erreur tolérée à la distance d, croissante en d
+ * Les distances sont bornées par maxDistance() avant l'appel à allowedError.
+ * La croissance garantit qu'un noeud à raffiner a un parent à raffiner lui aussi.
+ */
+
+/*
+ * Tolérance affine : baseError dans les régions, puis slope par unité de distance
+ * jusqu'à range (baseError + slope * range au-delà)
+ */
+struct LinearFalloff {
+    float baseError;
+    float slope;
+    float range;
+
+    LinearFalloff(float base = 0.0f, float s = 0.02f, float r = 1.0f) : baseError(base), slope(s), range(r) {}
+
+    float maxDistance() const { return range; }
+    float allowedError(float d) const { return baseError + slope * d; }
+};
+
+/*
+ * Tolérance par anneaux : errors[i] en deçà de la distance radii[i] (rayons et erreurs
+ * croissants), farError à partir du dernier anneau
+ */
+struct RingFalloff {
+    std::vector<float> radii;
+    std::vector<float> errors;
+    float farError;
+
+    RingFalloff(float far = 1e30f) : farError(far) {}
+
+    void addRing(float radius, float error) {
+        radii.push_back(radius);
+        errors.push_back(error);
+    }
+
+    float maxDistance() const { return radii.empty() ? 0.0f : radii.back(); }
+    float allowedError(float d) const {
+        for(unsigned int i = 0; i < radii.size(); ++i) {
+            if(d < radii[i])
+                return errors[i];
+        }
+        return farError;
+    }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
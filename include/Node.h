@@ -1,6 +1,8 @@
  #ifndef __NODE_H__
  #define __NODE_H__
 
+#include <vector>
+
 #include "VSplit.h"
 
 namespace CGoGN {
@@ -20,75 +22,128 @@ struct PFP: public PFP_STANDARD
 typedef PFP::MAP MAP;
 typedef PFP::VEC3 VEC3;
 
+const unsigned int NO_NODE = 0xffffffff;     //Indice de noeud absent
+const unsigned int NO_SPLIT = 0xffffffff;    //Noeud sans VSplit (feuille)
+const unsigned int NO_SLOT = 0xffffffff;     //Noeud absent du front
+
 /*
- * Classe définissant les différents noeuds de l'arbre des maillages progressifs
+ * Réserve des noeuds de la forêt des maillages progressifs.
+ * Les noeuds sont désignés par des indices 32 bits et stockés par champ dans des
+ * tableaux contigus (structure de tableaux), dans l'ordre de construction : les
+ * feuilles d'abord, puis chaque noeud interne après ses deux fils.
  */
-struct Node {
+class NodePool {
     public:
-        Node(VSplit<PFP>* vsplit = NULL, bool active = false, unsigned int vertex = -1, int height = 0)
-        :   m_parent(NULL), m_child_left(NULL), m_child_right(NULL), m_vsplit(vsplit), 
-            m_vertex(vertex), m_active(active), m_position(NULL), m_height(height)
-        {}
+        unsigned int size() const { return m_parent.size(); }
+
+        /*Octets alloués par les tableaux du pool*/
+        size_t memory() const {
+            return m_parent.capacity() * sizeof(unsigned int)
+                +  m_child_left.capacity() * sizeof(unsigned int)
+                +  m_child_right.capacity() * sizeof(unsigned int)
+                +  m_vsplit.capacity() * sizeof(unsigned int)
+                +  m_vertex.capacity() * sizeof(unsigned int)
+                +  m_active.capacity() * sizeof(unsigned char)
+                +  m_slot.capacity() * sizeof(unsigned int)
+                +  m_ancestor.capacity() * sizeof(unsigned int)
+                +  m_height.capacity() * sizeof(int);
+        }
 
-        ~Node() {
-            delete m_vsplit;
+        void reserve(unsigned int n) {
+            m_parent.reserve(n);
+            m_child_left.reserve(n);
+            m_child_right.reserve(n);
+            m_vsplit.reserve(n);
+            m_vertex.reserve(n);
+            m_height.reserve(n);
+            m_active.reserve(n);
+            m_slot.reserve(n);
+            m_ancestor.reserve(n);
         }
 
-        Node* getParent() { return m_parent; }
-        void setParent(Node* parent) { m_parent = parent; }
+        void clear() {
+            m_parent.clear();
+            m_child_left.clear();
+            m_child_right.clear();
+            m_vsplit.clear();
+            m_vertex.clear();
+            m_height.clear();
+            m_active.clear();
+            m_slot.clear();
+            m_ancestor.clear();
+        }
 
-        Node* getLeftChild() { return m_child_left; }
-        void setLeftChild(Node* child_left) { m_child_left = child_left; }
+        unsigned int addNode(unsigned int vsplit = NO_SPLIT, bool active = false, unsigned int vertex = -1, int height = 0) {
+            m_parent.push_back(NO_NODE);
+            m_child_left.push_back(NO_NODE);
+            m_child_right.push_back(NO_NODE);
+            m_vsplit.push_back(vsplit);
+            m_vertex.push_back(vertex);
+            m_height.push_back(height);
+            m_active.push_back(active);
+            m_slot.push_back(NO_SLOT);
+            m_ancestor.push_back(NO_NODE);
+            return m_parent.size() - 1;
+        }
 
-        Node* getRightChild() { return m_child_right; }
-        void setRightChild(Node* child_right) { m_child_right = child_right; }
-        
-        VSplit<PFP>* getVSplit() { return m_vsplit; }
-        void setVSplit(VSplit<PFP>* vsplit) { m_vsplit = vsplit; }
+        unsigned int getParent(unsigned int n) const { return m_parent[n]; }
+        void setParent(unsigned int n, unsigned int parent) { m_parent[n] = parent; }
 
-        unsigned int getVertex() { return m_vertex; }
-        void setVertex(unsigned int vertex) { m_vertex = vertex;  }
+        unsigned int getLeftChild(unsigned int n) const { return m_child_left[n]; }
+        void setLeftChild(unsigned int n, unsigned int child_left) { m_child_left[n] = child_left; }
 
-        bool isActive() { return m_active; } 
-        void setActive(bool active) { 
-            m_active = active;
-        }
+        unsigned int getRightChild(unsigned int n) const { return m_child_right[n]; }
+        void setRightChild(unsigned int n, unsigned int child_right) { m_child_right[n] = child_right; }
 
-        std::list<Node*>::iterator getCurrentPosition() { return m_position; }
-        void setCurrentPosition(std::list<Node*>::iterator position) { m_position = position; }
+        unsigned int getVSplit(unsigned int n) const { return m_vsplit[n]; }
+        void setVSplit(unsigned int n, unsigned int vsplit) { m_vsplit[n] = vsplit; }
 
-        int getHeight() { return m_height; }
-        void setHeight(int height) { m_height = height; }
+        unsigned int getVertex(unsigned int n) const { return m_vertex[n]; }
+        void setVertex(unsigned int n, unsigned int vertex) { m_vertex[n] = vertex; }
 
-        bool isEdgeCollapseLegal() { return m_parent!=NULL; }
+        bool isActive(unsigned int n) const { return m_active[n] != 0; }
+        void setActive(unsigned int n, bool active) { m_active[n] = active; }
 
-        bool operator==(const Node& n) {
-            return  m_parent == n.m_parent
-                &&  m_child_left == n.m_child_left
-                &&  m_child_right == n.m_child_right;
+        unsigned int getSlot(unsigned int n) const { return m_slot[n]; }
+        void setSlot(unsigned int n, unsigned int slot) { m_slot[n] = slot; }
+
+        /*
+         * Ancêtre actif mémorisé : toujours un ancêtre de n, valide tant qu'il est actif
+         * (le front est une coupe de chaque arbre, un chemin n'a qu'un noeud actif)
+         */
+        unsigned int getActiveAncestor(unsigned int n) const {
+            unsigned int a = m_ancestor[n];
+            return (a != NO_NODE && m_active[a]) ? a : NO_NODE;
         }
-        
+        void setActiveAncestor(unsigned int n, unsigned int ancestor) { m_ancestor[n] = ancestor; }
+
+        int getHeight(unsigned int n) const { return m_height[n]; }
+        void setHeight(unsigned int n, int height) { m_height[n] = height; }
+
+        bool isEdgeCollapseLegal(unsigned int n) const { return m_parent[n] != NO_NODE; }
+
     private:
         /*Liens dans l'arborescence*/
-        Node* m_parent;
-        Node* m_child_left;
-        Node* m_child_right;
-        
+        std::vector<unsigned int> m_parent;
+        std::vector<unsigned int> m_child_left;
+        std::vector<unsigned int> m_child_right;
+
         /*Informations pour la transformation*/
-        VSplit<PFP>* m_vsplit;
-        unsigned int m_vertex;
-        bool m_active;
+        std::vector<unsigned int> m_vsplit;
+        std::vector<unsigned int> m_vertex;
+        std::vector<unsigned char> m_active;
 
         /*Informations pour l'acces dans le front courant*/
-        std::list<Node*>::iterator m_position;
+        std::vector<unsigned int> m_slot;
+        std::vector<unsigned int> m_ancestor;   //Cache des ancêtres actifs (compression de chemins)
 
         /*Informations sur la position dans l'arbre (hauteur du noeud)*/
-        int  m_height;
+        std::vector<int> m_height;
 };
 
 typedef struct
 {
-    Node* node;
+    unsigned int node;
     static std::string CGoGNnameOfType() { return "NodeInfo" ; }
 } NodeInfo;
 
@@ -0,0 +1,272 @@
+ #ifndef __NODE_BOUNDS_H__
+ #define __NODE_BOUNDS_H__
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "Node.h"
+#include "Box.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Sphère englobante de la géométrie d'un sous-arbre de la forêt
+ */
+struct BoundingSphere {
+    VEC3 center;
+    float radius;
+
+    BoundingSphere() : center(0.0f, 0.0f, 0.0f), radius(0.0f) {}
+    BoundingSphere(const VEC3& c, float r) : center(c), radius(r) {}
+
+    //Plus petite sphère contenant les deux sphères
+    static BoundingSphere merge(const BoundingSphere& a, const BoundingSphere& b) {
+        VEC3 d = b.center - a.center;
+        float dist = d.norm();
+        if(dist + b.radius <= a.radius)
+            return a;
+        if(dist + a.radius <= b.radius)
+            return b;
+        float r = (dist + a.radius + b.radius) * 0.5f;
+        return BoundingSphere(a.center + d * ((r - a.radius) / dist), r);
+    }
+};
+
+const float HALF_PI = 1.57079632679f;
+
+/*
+ * Cône des normales des faces d'un sous-arbre : toutes les normales font un angle
+ * d'au plus 'angle' avec l'axe. Un demi-angle négatif désigne le cône vide, un
+ * demi-angle d'au moins pi/2 un cône qui ne permet aucun rejet des faces arrière.
+ */
+struct NormalCone {
+    VEC3 axis;
+    float angle;
+    float sinAngle, cosAngle;
+
+    NormalCone() : axis(0.0f, 0.0f, 1.0f), angle(-1.0f), sinAngle(0.0f), cosAngle(1.0f) {}
+    NormalCone(const VEC3& a, float alpha) : axis(a) { setAngle(alpha); }
+
+    bool isEmpty() const { return angle < 0.0f; }
+    bool isFull() const { return angle >= HALF_PI; }
+
+    void setAngle(float alpha) {
+        angle = alpha;
+        sinAngle = std::sin(alpha);
+        cosAngle = std::cos(alpha);
+    }
+
+    //Plus petit cône contenant les deux cônes
+    static NormalCone merge(const NormalCone& a, const NormalCone& b) {
+        if(a.isEmpty()) return b;
+        if(b.isEmpty()) return a;
+        if(a.isFull()) return a;
+        if(b.isFull()) return b;
+        float c = std::max(-1.0f, std::min(1.0f, a.axis * b.axis));
+        float theta = std::acos(c);
+        if(theta + b.angle <= a.angle)
+            return a;
+        if(theta + a.angle <= b.angle)
+            return b;
+        float alpha = (a.angle + b.angle + theta) * 0.5f;
+        float s = std::sin(theta);
+        if(alpha >= HALF_PI || s < 1e-6f)
+            return NormalCone(a.axis, HALF_PI);
+        //Rotation de l'axe de a vers celui de b
+        float t = alpha - a.angle;
+        VEC3 axis = a.axis * (std::sin(theta - t) / s) + b.axis * (std::sin(t) / s);
+        axis.normalize();
+        return NormalCone(axis, alpha);
+    }
+};
+
+/*
+ * Région touchée par une mise à jour du raffinement : union de boîtes alignées.
+ * Pour un déplacement de la boîte d'intérêt, c'est la différence symétrique entre
+ * l'ancienne et la nouvelle boîte (au plus six tranches de chaque côté) : hors de
+ * cette région, l'appartenance d'un point à la boîte n'a pas changé.
+ */
+struct UpdateRegion {
+    std::vector<VEC3> pos_min;
+    std::vector<VEC3> pos_max;
+
+    bool empty() const { return pos_min.empty(); }
+
+    void clear() {
+        pos_min.clear();
+        pos_max.clear();
+    }
+
+    void addBox(const VEC3& bmin, const VEC3& bmax) {
+        pos_min.push_back(bmin);
+        pos_max.push_back(bmax);
+    }
+
+    void addRegion(const UpdateRegion& region) {
+        pos_min.insert(pos_min.end(), region.pos_min.begin(), region.pos_min.end());
+        pos_max.insert(pos_max.end(), region.pos_max.begin(), region.pos_max.end());
+    }
+
+    //Ajoute la partie de la boîte A qui n'est pas dans la boîte B
+    void addDifference(const VEC3& a_min, const VEC3& a_max, const VEC3& b_min, const VEC3& b_max) {
+        for(unsigned int k = 0; k < 3; ++k) {
+            if(a_max[k] < b_min[k] || b_max[k] < a_min[k]) {
+                //Boîtes disjointes
+                addBox(a_min, a_max);
+                return;
+            }
+        }
+        VEC3 cur_min = a_min;
+        VEC3 cur_max = a_max;
+        for(unsigned int k = 0; k < 3; ++k) {
+            if(cur_min[k] < b_min[k]) {
+                VEC3 slab_max = cur_max;
+                slab_max[k] = b_min[k];
+                addBox(cur_min, slab_max);
+                cur_min[k] = b_min[k];
+            }
+            if(cur_max[k] > b_max[k]) {
+                VEC3 slab_min = cur_min;
+                slab_min[k] = b_max[k];
+                addBox(slab_min, cur_max);
+                cur_max[k] = b_max[k];
+            }
+        }
+    }
+
+    //Différence symétrique de deux boîtes
+    void addSymmetricDifference(const VEC3& a_min, const VEC3& a_max, const VEC3& b_min, const VEC3& b_max) {
+        addDifference(a_min, a_max, b_min, b_max);
+        addDifference(b_min, b_max, a_min, a_max);
+    }
+
+    bool intersects(const BoundingSphere& s) const {
+        for(unsigned int i = 0; i < pos_min.size(); ++i) {
+            if(Box::intersects(pos_min[i], pos_max[i], s.center, s.radius))
+                return true;
+        }
+        return false;
+    }
+};
+
+/*
+ * Hiérarchie de sphères englobantes au-dessus des racines de la forêt : les arbres
+ * de la forêt s'arrêtent à leur racine, cette hiérarchie binaire les regroupe pour
+ * que la recherche des racines touchées par une région ne parcoure pas toutes les
+ * racines. Construite par coupes médianes selon le plus grand axe des centres.
+ */
+class RootHierarchy {
+    public:
+        static const unsigned int LEAF_SIZE = 8;    //Nombre maximal de racines par feuille
+
+        void clear() {
+            m_bvh.clear();
+            m_roots.clear();
+        }
+
+        unsigned int nbRoots() const { return m_roots.size(); }
+        size_t memory() const { return m_bvh.capacity() * sizeof(BVHNode) + m_roots.capacity() * sizeof(unsigned int); }
+
+        void build(const std::vector<unsigned int>& roots, const std::vector<BoundingSphere>& spheres) {
+            clear();
+            m_roots = roots;
+            if(!m_roots.empty())
+                buildNode(0, m_roots.size(), spheres);
+        }
+
+        //Racines dont la sphère touche la région
+        void query(const UpdateRegion& region, const std::vector<BoundingSphere>& spheres, std::vector<unsigned int>& roots) const {
+            if(m_bvh.empty())
+                return;
+            std::vector<unsigned int> pile;
+            pile.push_back(0);
+            while(!pile.empty()) {
+                const BVHNode& b = m_bvh[pile.back()];
+                pile.pop_back();
+                if(!region.intersects(b.sphere))
+                    continue;
+                if(b.left == NO_NODE) {
+                    for(unsigned int i = b.first; i < b.first + b.count; ++i) {
+                        if(region.intersects(spheres[m_roots[i]]))
+                            roots.push_back(m_roots[i]);
+                    }
+                }
+                else {
+                    pile.push_back(b.right);
+                    pile.push_back(b.left);
+                }
+            }
+        }
+
+    private:
+        struct BVHNode {
+            BoundingSphere sphere;
+            unsigned int left, right;   //NO_NODE pour une feuille
+            unsigned int first, count;  //Racines de la feuille dans m_roots
+        };
+
+        struct CenterLess {
+            const std::vector<BoundingSphere>& spheres;
+            unsigned int axis;
+            CenterLess(const std::vector<BoundingSphere>& s, unsigned int a) : spheres(s), axis(a) {}
+            bool operator()(unsigned int a, unsigned int b) const { return spheres[a].center[axis] < spheres[b].center[axis]; }
+        };
+
+        std::vector<BVHNode> m_bvh;
+        std::vector<unsigned int> m_roots;
+
+        unsigned int buildNode(unsigned int first, unsigned int count, const std::vector<BoundingSphere>& spheres) {
+            unsigned int id = m_bvh.size();
+            m_bvh.push_back(BVHNode());
+            m_bvh[id].left = NO_NODE;
+            m_bvh[id].right = NO_NODE;
+            m_bvh[id].first = first;
+            m_bvh[id].count = count;
+
+            if(count <= LEAF_SIZE) {
+                BoundingSphere s = spheres[m_roots[first]];
+                for(unsigned int i = first + 1; i < first + count; ++i)
+                    s = BoundingSphere::merge(s, spheres[m_roots[i]]);
+                m_bvh[id].sphere = s;
+                return id;
+            }
+
+            VEC3 cmin = spheres[m_roots[first]].center;
+            VEC3 cmax = cmin;
+            for(unsigned int i = first + 1; i < first + count; ++i) {
+                const VEC3& c = spheres[m_roots[i]].center;
+                for(unsigned int k = 0; k < 3; ++k) {
+                    cmin[k] = std::min(cmin[k], c[k]);
+                    cmax[k] = std::max(cmax[k], c[k]);
+                }
+            }
+            VEC3 extent = cmax - cmin;
+            unsigned int axis = 0;
+            if(extent[1] > extent[axis]) axis = 1;
+            if(extent[2] > extent[axis]) axis = 2;
+
+            unsigned int half = count / 2;
+            std::nth_element(m_roots.begin() + first, m_roots.begin() + first + half, m_roots.begin() + first + count, CenterLess(spheres, axis));
+
+            unsigned int left = buildNode(first, half, spheres);
+            unsigned int right = buildNode(first + half, count - half, spheres);
+            m_bvh[id].left = left;
+            m_bvh[id].right = right;
+            m_bvh[id].sphere = BoundingSphere::merge(m_bvh[left].sphere, m_bvh[right].sphere);
+            return id;
+        }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,315 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __VDPM_PROFILER_H__
+#define __VDPM_PROFILER_H__
+
+#include <ostream>
+
+#include "Timing.h"
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Compteurs des opérations du maillage progressif. Les deux derniers sont des
+ * jauges : valeur courante du front, profondeur maximale de la pile de forceRefine
+ * pendant la trame.
+ */
+enum ProfileCounter
+{
+	PROF_REFINE_ATTEMPTED = 0,
+	PROF_REFINE_APPLIED,
+	PROF_REFINE_REJECTED,       //Brins inactifs autour de la paire de faces, ou mauvaise orientation
+	PROF_COARSEN_ATTEMPTED,
+	PROF_COARSEN_APPLIED,
+	PROF_COARSEN_REJECTED,      //Brins inactifs autour de la paire de faces
+	PROF_FORCE_CALLS,
+	PROF_COLLAPSE_ATTEMPTED,    //Contractions envisagées par createPM
+	PROF_COLLAPSE_APPLIED,
+	PROF_COLLAPSE_REJECTED,     //Entrées périmées ou contractions illégales
+	PROF_FRONT_SIZE,
+	PROF_FORCE_MAX_DEPTH,
+	PROF_NB_COUNTERS
+} ;
+
+/*
+ * Phases chronométrées ; les phases imbriquées sont comptées aussi dans leur parente
+ */
+enum ProfilePhase
+{
+	PHASE_UPDATE_REFINEMENT = 0,
+	PHASE_SCAN,                 //Parcours complet du front
+	PHASE_PENDING,              //Descente dans la région en attente
+	PHASE_PARALLEL,             //Mise à jour parallèle par tours
+	PHASE_PREFETCH,
+	PHASE_FORCE_REFINE,
+	PHASE_CREATE_PM,
+	PHASE_COLLAPSES,            //Contractions de createPM
+	PHASE_BOUNDS,
+	PHASE_UPDATE_MESH,          //Phases de l'application
+	PHASE_MESH_NORMALS,
+	PHASE_MESH_BUFFERS,
+	PHASE_MESH_UPLOAD,
+	PROF_NB_PHASES
+} ;
+
+/*
+ * Valeurs des compteurs et des phases, cumulées ou pour une trame
+ */
+struct ProfileStats
+{
+	unsigned long counters[PROF_NB_COUNTERS] ;
+	double seconds[PROF_NB_PHASES] ;
+	unsigned long calls[PROF_NB_PHASES] ;
+
+	ProfileStats() { clear() ; }
+
+	void clear()
+	{
+		for(unsigned int i = 0; i < PROF_NB_COUNTERS; ++i)
+			counters[i] = 0 ;
+		for(unsigned int i = 0; i < PROF_NB_PHASES; ++i)
+		{
+			seconds[i] = 0. ;
+			calls[i] = 0 ;
+		}
+	}
+
+	static bool isGauge(unsigned int c) { return c >= PROF_FRONT_SIZE ; }
+} ;
+
+/*
+ * Instrumentation du maillage progressif, unique pour le programme. Les compteurs
+ * et les durées sont cumulés depuis reset() ; endFrame() en extrait la trame écoulée
+ * (différence avec la trame précédente, jauges relevées puis la profondeur remise à
+ * zéro). Les ajouts sont atomiques : la mise à jour parallèle et le thread de mise à
+ * jour en tâche de fond incrémentent les mêmes compteurs.
+ * L'instrumentation n'est compilée qu'avec VDPMESH_PROFILE (macros VDPM_*) : sans
+ * elle, la classe reste disponible mais ses valeurs restent nulles.
+ */
+class Profiler
+{
+public:
+	static Profiler& instance()
+	{
+		static Profiler profiler ;
+		return profiler ;
+	}
+
+	static bool enabled()
+	{
+#ifdef VDPMESH_PROFILE
+		return true ;
+#else
+		return false ;
+#endif
+	}
+
+	void add(ProfileCounter c, unsigned long k)
+	{
+		#pragma omp atomic
+		m_total.counters[c] += k ;
+	}
+
+	void set(ProfileCounter c, unsigned long v)
+	{
+		m_total.counters[c] = v ;
+	}
+
+	void setMax(ProfileCounter c, unsigned long v)
+	{
+		#pragma omp critical(vdpm_profile)
+		{
+			if(v > m_total.counters[c])
+				m_total.counters[c] = v ;
+		}
+	}
+
+	void addTime(ProfilePhase p, double s)
+	{
+		#pragma omp atomic
+		m_total.seconds[p] += s ;
+		#pragma omp atomic
+		m_total.calls[p] += 1 ;
+	}
+
+	void reset()
+	{
+		m_total.clear() ;
+		m_previous.clear() ;
+		m_frame.clear() ;
+		m_nbFrames = 0 ;
+	}
+
+	//Clôt la trame courante : frame() contient ensuite ses valeurs
+	void endFrame()
+	{
+		ProfileStats current = m_total ;
+		for(unsigned int i = 0; i < PROF_NB_COUNTERS; ++i)
+			m_frame.counters[i] = ProfileStats::isGauge(i) ? current.counters[i] : current.counters[i] - m_previous.counters[i] ;
+		for(unsigned int i = 0; i < PROF_NB_PHASES; ++i)
+		{
+			m_frame.seconds[i] = current.seconds[i] - m_previous.seconds[i] ;
+			m_frame.calls[i] = current.calls[i] - m_previous.calls[i] ;
+		}
+		m_previous = current ;
+		#pragma omp critical(vdpm_profile)
+		m_total.counters[PROF_FORCE_MAX_DEPTH] = 0 ;
+		++m_nbFrames ;
+	}
+
+	const ProfileStats& total() const { return m_total ; }
+	const ProfileStats& frame() const { return m_frame ; }
+	unsigned int nbFrames() const { return m_nbFrames ; }
+
+	//Vrai si la trame a compté des opérations ou chronométré une phase
+	bool frameActive() const
+	{
+		for(unsigned int i = 0; i < PROF_NB_PHASES; ++i)
+			if(m_frame.calls[i] > 0)
+				return true ;
+		for(unsigned int i = 0; i < PROF_FRONT_SIZE; ++i)
+			if(m_frame.counters[i] > 0)
+				return true ;
+		return false ;
+	}
+
+	static const char* counterName(unsigned int c)
+	{
+		static const char* names[PROF_NB_COUNTERS] = {
+			"refine_attempted", "refine_applied", "refine_rejected",
+			"coarsen_attempted", "coarsen_applied", "coarsen_rejected",
+			"force_calls",
+			"collapse_attempted", "collapse_applied", "collapse_rejected",
+			"front_size", "force_max_depth"
+		} ;
+		return names[c] ;
+	}
+
+	static const char* phaseName(unsigned int p)
+	{
+		static const char* names[PROF_NB_PHASES] = {
+			"update_refinement", "scan", "pending", "parallel", "prefetch", "force_refine",
+			"create_pm", "collapses", "bounds",
+			"update_mesh", "mesh_normals", "mesh_buffers", "mesh_upload"
+		} ;
+		return names[p] ;
+	}
+
+	/*
+	 * Une ligne CSV par trame : numéro, compteurs, puis durée (ms) et nombre
+	 * d'appels de chaque phase
+	 */
+	static void writeCSVHeader(std::ostream& out)
+	{
+		out << "frame" ;
+		for(unsigned int i = 0; i < PROF_NB_COUNTERS; ++i)
+			out << "," << counterName(i) ;
+		for(unsigned int i = 0; i < PROF_NB_PHASES; ++i)
+			out << "," << phaseName(i) << "_ms," << phaseName(i) << "_calls" ;
+		out << "\n" ;
+	}
+
+	void writeCSVRow(std::ostream& out) const
+	{
+		out << m_nbFrames ;
+		for(unsigned int i = 0; i < PROF_NB_COUNTERS; ++i)
+			out << "," << m_frame.counters[i] ;
+		for(unsigned int i = 0; i < PROF_NB_PHASES; ++i)
+			out << "," << 1e3 * m_frame.seconds[i] << "," << m_frame.calls[i] ;
+		out << "\n" ;
+	}
+
+	//Résumé lisible : valeurs de la trame et cumuls, phases appelées seulement
+	void writeReport(std::ostream& out) const
+	{
+		for(unsigned int i = 0; i < PROF_NB_COUNTERS; ++i)
+			out << counterName(i) << " : " << m_frame.counters[i] << " (" << m_total.counters[i] << ")\n" ;
+		for(unsigned int i = 0; i < PROF_NB_PHASES; ++i)
+		{
+			if(m_total.calls[i] == 0)
+				continue ;
+			out << phaseName(i) << " : " << 1e3 * m_frame.seconds[i] << " ms x" << m_frame.calls[i]
+			    << " (" << 1e3 * m_total.seconds[i] << " ms x" << m_total.calls[i] << ")\n" ;
+		}
+	}
+
+private:
+	ProfileStats m_total ;
+	ProfileStats m_previous ;   //Cumuls à la fin de la trame précédente
+	ProfileStats m_frame ;
+	unsigned int m_nbFrames ;
+
+	Profiler() : m_nbFrames(0) {}
+	Profiler(const Profiler&) ;
+	Profiler& operator=(const Profiler&) ;
+} ;
+
+/*
+ * Durée d'une portée, ajoutée à sa phase en sortie
+ */
+class ScopedTimer
+{
+public:
+	explicit ScopedTimer(ProfilePhase phase) : m_phase(phase), m_start(wallClock()) {}
+	~ScopedTimer() { Profiler::instance().addTime(m_phase, wallClock() - m_start) ; }
+
+private:
+	ProfilePhase m_phase ;
+	double m_start ;
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+/*
+ * Points d'instrumentation, vides sans VDPMESH_PROFILE
+ */
+#ifdef VDPMESH_PROFILE
+#define VDPM_COUNT(c) ::CGoGN::Algo::Surface::VDPMesh::Profiler::instance().add(::CGoGN::Algo::Surface::VDPMesh::c, 1)
+#define VDPM_COUNT_ADD(c, k) ::CGoGN::Algo::Surface::VDPMesh::Profiler::instance().add(::CGoGN::Algo::Surface::VDPMesh::c, (k))
+#define VDPM_SET(c, v) ::CGoGN::Algo::Surface::VDPMesh::Profiler::instance().set(::CGoGN::Algo::Surface::VDPMesh::c, (v))
+#define VDPM_MAX(c, v) ::CGoGN::Algo::Surface::VDPMesh::Profiler::instance().setMax(::CGoGN::Algo::Surface::VDPMesh::c, (v))
+#define VDPM_TIMER(p) ::CGoGN::Algo::Surface::VDPMesh::ScopedTimer vdpm_timer_##p(::CGoGN::Algo::Surface::VDPMesh::p)
+#else
+#define VDPM_COUNT(c) ((void)0)
+#define VDPM_COUNT_ADD(c, k) ((void)0)
+#define VDPM_SET(c, v) ((void)0)
+#define VDPM_MAX(c, v) ((void)0)
+#define VDPM_TIMER(p) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,378 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __REFINEMENT_WORKER_H__
+#define __REFINEMENT_WORKER_H__
+
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QMetaObject>
+
+#include "VDPMesh.h"
+#include "FrontSnapshot.h"
+#include "IndexBuffers.h"
+#include "FrontNormals.h"
+#include "Timing.h"
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Mise à jour du raffinement en tâche de fond.
+ * Le thread de travail est le seul à modifier la carte tant qu'il tourne : il
+ * enchaîne les tranches de updateRefinement (ou une mise à jour parallèle
+ * complète) et publie une copie du maillage actif (FrontSnapshot) après chaque
+ * tranche qui l'a modifié.
+ * Les copies sont doublées : le thread remplit l'une pendant que le thread
+ * graphique lit l'autre, et la publication se limite à échanger les deux. Le suivi
+ * des changements du maillage reste actif : les primitives (FrontBuffers) et les
+ * normales (FrontNormals) sont revues autour des seules transformations, et chaque
+ * copie ne reçoit que les places et lignes modifiées depuis qu'elle a été remplie.
+ * Les déplacements de la boîte demandés entre deux tranches sont fusionnés : seule
+ * la dernière cible est appliquée, et la copie n'est pas publiée tant qu'une cible
+ * attend (au plus MAX_DEFERRED tranches de suite). Une fois le front convergé, le temps libre sert
+ * au raffinement spéculatif (updatePrefetch), interrompu par toute nouvelle demande ;
+ * chaque cible appliquée est relevée pour la prédiction, et une spéculation en cours
+ * est défaite quand aucune cible n'arrive pendant BoxPredictor::REST_DELAY ms.
+ * Le thread graphique est prévenu par un appel différé (Qt::QueuedConnection) de
+ * la méthode snapshotSlot du récepteur, une seule fois par copie non encore lue.
+ * Tout autre accès à la carte ou au maillage progressif depuis un autre thread se
+ * fait en tenant mapMutex(), libéré entre deux tranches.
+ */
+template <typename PFP>
+class RefinementWorker : public QThread
+{
+public:
+	typedef typename PFP::MAP MAP ;
+	typedef typename PFP::VEC3 VEC3 ;
+
+	static const unsigned int MAX_DEFERRED = 4 ;    //Tranches de suite sans publication
+
+	//Le maillage progressif est lu ensuite par le seul thread de travail : ses
+	//changements alimentent les primitives du thread, reconstruites une première fois
+	RefinementWorker(VDProgressiveMesh<PFP>& pmesh, MAP& map, DartMarker& inactive,
+	                 const VertexAttribute<VEC3>& position, VertexAttribute<VEC3>& normal,
+	                 QObject* receiver, const char* snapshotSlot, double slice) :
+		m_pmesh(pmesh), m_map(map), m_inactive(inactive), m_position(position), m_normal(normal),
+		m_receiver(receiver), m_snapshotSlot(snapshotSlot), m_slice(slice),
+		m_stop(false), m_hasTarget(false), m_dirty(true), m_parallel(false),
+		m_published(0), m_fresh(false), m_generation(0)
+	{
+		m_pmesh.setChangeTracking(true) ;
+		m_stale[0].full = m_stale[1].full = true ;
+	}
+
+	~RefinementWorker()
+	{
+		stop() ;
+	}
+
+	//Arrête le thread après la tranche en cours
+	void stop()
+	{
+		{
+			QMutexLocker lock(&m_stateMutex) ;
+			m_stop = true ;
+			m_wake.wakeAll() ;
+		}
+		wait() ;
+	}
+
+	//Nouvelle cible de la boîte d'intérêt (remplace une cible pas encore appliquée)
+	void setTarget(const VEC3& pos_min, const VEC3& pos_max)
+	{
+		QMutexLocker lock(&m_stateMutex) ;
+		m_targetMin = pos_min ;
+		m_targetMax = pos_max ;
+		m_hasTarget = true ;
+		m_wake.wakeAll() ;
+	}
+
+	//Demande une mise à jour après une modification faite sous mapMutex()
+	void wake()
+	{
+		QMutexLocker lock(&m_stateMutex) ;
+		m_dirty = true ;
+		m_wake.wakeAll() ;
+	}
+
+	void setParallel(bool b)
+	{
+		QMutexLocker lock(&m_stateMutex) ;
+		m_parallel = b ;
+		m_dirty = true ;
+		m_wake.wakeAll() ;
+	}
+
+	QMutex& mapMutex() { return m_mapMutex ; }
+
+	/*
+	 * Accès à la dernière copie publiée, jusqu'à unlockSnapshot()
+	 */
+	const FrontSnapshot& lockSnapshot()
+	{
+		m_snapshotMutex.lock() ;
+		m_fresh = false ;
+		return m_snapshots[m_published] ;
+	}
+
+	void unlockSnapshot() { m_snapshotMutex.unlock() ; }
+
+protected:
+	void run()
+	{
+		bool converged = false ;
+		bool prefetched = false ;
+		bool prefetching = false ;  //Zone anticipée en place
+		bool unpublished = false ;  //Changements pas encore publiés
+		unsigned int deferred = 0 ;
+		for(;;)
+		{
+			bool hasTarget ;
+			bool request ;
+			bool parallel ;
+			bool atRest = false ;
+			VEC3 targetMin, targetMax ;
+			{
+				QMutexLocker lock(&m_stateMutex) ;
+				while(!m_stop && !m_hasTarget && !m_dirty && converged && prefetched)
+				{
+					if(!prefetching)
+						m_wake.wait(&m_stateMutex) ;
+					else if(!m_wake.wait(&m_stateMutex, BoxPredictor::REST_DELAY))
+					{
+						//Boîte immobile : la spéculation est défaite au passage suivant
+						atRest = true ;
+						break ;
+					}
+				}
+				if(m_stop)
+					return ;
+				hasTarget = m_hasTarget ;
+				request = m_hasTarget || m_dirty ;
+				targetMin = m_targetMin ;
+				targetMax = m_targetMax ;
+				parallel = m_parallel ;
+				m_hasTarget = false ;
+				m_dirty = false ;
+			}
+
+			{
+				QMutexLocker lock(&m_mapMutex) ;
+				if(hasTarget)
+				{
+					m_pmesh.getInterestBox()->setPosMin(targetMin) ;
+					m_pmesh.getInterestBox()->setPosMax(targetMax) ;
+				}
+				if(hasTarget || atRest)
+					m_pmesh.recordInterestBox() ;
+				if(converged && !request)
+				{
+					prefetched = m_pmesh.updatePrefetch(RefinementBudget(0, m_slice)) ;
+					prefetching = m_pmesh.isPrefetching() ;
+				}
+				else if(parallel)
+				{
+					m_pmesh.updateRefinementParallel() ;
+					converged = true ;
+					prefetched = false ;
+				}
+				else
+				{
+					converged = m_pmesh.updateRefinement(RefinementBudget(0, m_slice)) ;
+					prefetched = false ;
+				}
+				unpublished = collectChanges() || unpublished ;
+			}
+			if(!unpublished)
+				continue ;
+			{
+				//Nouvelle cible déjà arrivée : elle est fusionnée avant publication
+				QMutexLocker lock(&m_stateMutex) ;
+				if(m_hasTarget && !m_stop && ++deferred < MAX_DEFERRED)
+					continue ;
+			}
+			deferred = 0 ;
+			unpublished = false ;
+
+			//La copie en cours de remplissage n'est jamais celle que lit le thread graphique
+			unsigned int b = 1 - m_published ;
+			patchSnapshot(m_snapshots[b], m_stale[b]) ;
+			m_snapshots[b].generation = ++m_generation ;
+
+			bool notify ;
+			{
+				QMutexLocker lock(&m_snapshotMutex) ;
+				m_published = 1 - m_published ;
+				notify = !m_fresh ;
+				m_fresh = true ;
+			}
+			if(notify)
+				QMetaObject::invokeMethod(m_receiver, m_snapshotSlot, Qt::QueuedConnection) ;
+		}
+	}
+
+private:
+	//Places de primitives (sommets, arêtes, triangles) et lignes de normales à reporter
+	//dans une copie depuis qu'elle a été remplie ; full : copie complète
+	struct Stale
+	{
+		std::vector<unsigned int> slots[3] ;
+		std::vector<unsigned int> lines ;
+		bool full ;
+		Stale() : full(false) {}
+	} ;
+
+	/*
+	 * Applique les changements du maillage aux primitives et aux normales du thread
+	 * et note, pour chacune des deux copies, ce qu'elles doivent reprendre. Sous
+	 * mapMutex. Faux si le maillage n'a pas changé.
+	 */
+	bool collectChanges()
+	{
+		FrontChanges& changes = m_pmesh.getChanges() ;
+		if(!changes.rebuild && changes.darts.empty() && changes.nodes.empty())
+			return false ;
+		bool rebuild = changes.rebuild ;
+		//Les normales sont revues avant que apply() n'efface les changements
+		if(rebuild)
+			Algo::Surface::Geometry::computeNormalVertices<PFP>(m_map, m_position, m_normal) ;
+		else
+			m_normals.update(m_map, m_inactive, m_position, m_normal, changes) ;
+		m_buffers.apply(m_map, m_inactive, m_pmesh.getNodes(), changes) ;
+
+		const PatchedIndexArray* arrays[3] = { &m_buffers.points, &m_buffers.lines, &m_buffers.triangles } ;
+		for(unsigned int s = 0 ; s < 2 ; ++s)
+		{
+			Stale& st = m_stale[s] ;
+			st.full = st.full || rebuild ;
+			if(st.full)
+				continue ;
+			for(unsigned int p = 0 ; p < 3 ; ++p)
+				st.slots[p].insert(st.slots[p].end(), arrays[p]->dirtySlots().begin(), arrays[p]->dirtySlots().end()) ;
+			st.lines.insert(st.lines.end(), m_normals.touched().begin(), m_normals.touched().end()) ;
+		}
+		m_buffers.clearDirty() ;
+		return true ;
+	}
+
+	/*
+	 * Reporte dans la copie les places et lignes notées depuis qu'elle a été remplie.
+	 * Les primitives et normales du thread ne sont modifiées que par ce thread : pas
+	 * de verrou
+	 */
+	void patchSnapshot(FrontSnapshot& snap, Stale& st)
+	{
+		const PatchedIndexArray* arrays[3] = { &m_buffers.points, &m_buffers.lines, &m_buffers.triangles } ;
+		std::vector<unsigned int>* dst[3] = { &snap.points, &snap.lines, &snap.triangles } ;
+		for(unsigned int p = 0 ; p < 3 ; ++p)
+		{
+			const std::vector<unsigned int>& src = arrays[p]->indices() ;
+			unsigned int arity = arrays[p]->arity() ;
+			if(st.full)
+				dst[p]->assign(src.begin(), src.end()) ;
+			else
+			{
+				//Places supprimées par un resserrement : au-delà de la nouvelle taille
+				dst[p]->resize(src.size()) ;
+				for(unsigned int i = 0 ; i < st.slots[p].size() ; ++i)
+				{
+					unsigned int first = st.slots[p][i] * arity ;
+					if(first < src.size())
+						std::copy(src.begin() + first, src.begin() + first + arity, dst[p]->begin() + first) ;
+				}
+			}
+			st.slots[p].clear() ;
+		}
+
+		if(snap.normals.size() != m_normal.end())
+		{
+			snap.normals.resize(m_normal.end()) ;
+			st.full = true ;
+		}
+		if(st.full)
+		{
+			for(unsigned int i = m_normal.begin() ; i != m_normal.end() ; m_normal.next(i))
+				snap.normals[i] = m_normal[i] ;
+		}
+		else
+		{
+			for(unsigned int i = 0 ; i < st.lines.size() ; ++i)
+				snap.normals[st.lines[i]] = m_normal[st.lines[i]] ;
+		}
+		st.lines.clear() ;
+		st.full = false ;
+	}
+
+	VDProgressiveMesh<PFP>& m_pmesh ;
+	MAP& m_map ;
+	DartMarker& m_inactive ;
+	VertexAttribute<VEC3> m_position ;
+	VertexAttribute<VEC3> m_normal ;
+
+	QObject* m_receiver ;
+	const char* m_snapshotSlot ;
+	double m_slice ;    //Durée d'une tranche de mise à jour (s)
+
+	/*Demandes du thread graphique*/
+	QMutex m_stateMutex ;
+	QWaitCondition m_wake ;
+	bool m_stop ;
+	bool m_hasTarget ;
+	VEC3 m_targetMin, m_targetMax ;
+	bool m_dirty ;
+	bool m_parallel ;
+
+	QMutex m_mapMutex ;
+
+	/*Primitives et normales tenues à jour par le thread, reportées dans les copies*/
+	FrontBuffers<PFP> m_buffers ;
+	FrontNormals<PFP> m_normals ;
+	Stale m_stale[2] ;
+
+	/*Copies doublées : m_snapshots[m_published] est la dernière publiée*/
+	QMutex m_snapshotMutex ;
+	FrontSnapshot m_snapshots[2] ;
+	unsigned int m_published ;
+	bool m_fresh ;      //Copie publiée pas encore lue
+	unsigned int m_generation ;
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
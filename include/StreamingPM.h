@@ -0,0 +1,140 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __STREAMING_PM_H__
+#define __STREAMING_PM_H__
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "VDPMesh.h"
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Construction hors mémoire centrale de la hiérarchie pour les maillages OFF qui ne
+ * tiennent pas en mémoire.
+ *
+ * L'entrée est lue en flux et découpée en morceaux spatialement cohérents (cellules
+ * d'une grille fine regroupées dans l'ordre de Morton jusqu'à atteindre le budget
+ * mémoire). Chaque morceau est chargé seul dans une carte, les sommets de couture
+ * (partagés avec un autre morceau) y sont verrouillés, puis sa forêt et ses VSplit
+ * sont écrits sur disque au format du cache de hiérarchie avant que la carte ne soit
+ * libérée. Seuls le morceau courant, des tampons bornés par une part du budget et les
+ * fichiers projetés (positions, drapeaux de couture) sont présents en mémoire ; les
+ * pages des fichiers projetés sont comptées dans la mémoire résidente mais restent
+ * récupérables par le système.
+ *
+ * La taille des morceaux repose sur une estimation de la mémoire par face, vérifiée
+ * sur le premier morceau : si le pic de mémoire résidente mesuré dépasse le budget,
+ * l'estimation est corrigée et l'entrée redécoupée (une seule fois).
+ *
+ * Une passe de couture réunit ensuite les racines de tous les morceaux (leurs fronts
+ * grossiers, coutures comprises, les sommets de couture étant communs) en un seul
+ * maillage, top.off, dont la hiérarchie construite sans verrou forme les niveaux
+ * supérieurs : elle est enregistrée à côté (top.off.vdpm) et se recharge comme le
+ * cache de n'importe quel maillage. top.roots associe chaque sommet de top.off aux
+ * racines des morceaux qui le portent. Cette passe tient en mémoire le maillage des
+ * racines, soit le pourcentage demandé de l'entrée.
+ */
+template <typename PFP>
+class StreamingPMBuilder
+{
+public:
+	typedef typename PFP::MAP MAP ;
+	typedef typename PFP::VEC3 VEC3 ;
+	typedef typename PFP::REAL REAL ;
+
+	static const unsigned int FINE_RES = 64 ;              //Résolution de la grille fine
+	static const unsigned int DEFAULT_BYTES_PER_FACE = 1024 ;  //Estimation initiale carte + hiérarchie par face
+	static const unsigned int FLUSH_FACES = 256 ;          //Taille des tampons d'écriture par morceau
+	static const unsigned int BUFFER_SHARE = 8 ;           //Tampons d'écriture : 1/BUFFER_SHARE du budget
+
+private:
+	std::string m_workDir ;
+	size_t m_memoryBudget ;
+	unsigned int m_percentWantedVertices ;
+	BuildMode m_buildMode ;
+	size_t m_bytesPerFace ;
+
+	unsigned int m_nbVertices ;
+	unsigned int m_nbFaces ;
+	VEC3 m_min, m_max ;
+
+	std::vector<unsigned int> m_cellFaces ;      //Triangles de chaque cellule de la grille fine
+	std::vector<unsigned int> m_chunkOfCell ;    //Morceau de chaque cellule de la grille fine
+	unsigned int m_nbChunks ;
+
+	std::string positionsFile() { return m_workDir + "/positions.bin" ; }
+	std::string seamFile() { return m_workDir + "/seam.bin" ; }
+	std::string chunkFile(unsigned int c, const std::string& ext) ;
+	std::string topFile() { return m_workDir + "/top.off" ; }
+
+	unsigned int cellOf(const VEC3& p) ;
+	bool readHeader(std::ifstream& in) ;
+	bool readFace(std::ifstream& in, std::vector<unsigned int>& face) ;
+
+	bool streamVertices(const std::string& offFile) ;
+	bool countFaces(const std::string& offFile) ;
+	void partition() ;
+	bool flushChunk(unsigned int c, std::vector<unsigned int>& buffer, size_t& buffered) ;
+	bool distributeFaces(const std::string& offFile) ;
+	bool buildChunk(unsigned int c, unsigned long long inputHash, unsigned int& nbFaces) ;
+	bool writeRoots(unsigned int c, MAP& map, DartMarker& inactive, CellMarker<VERTEX>& locked,
+	                VDProgressiveMesh<PFP>& pmesh, const std::string& positionName) ;
+	bool buildChunks(const std::string& offFile, unsigned long long inputHash) ;
+	bool mergeSeams(unsigned long long& key) ;
+
+public:
+	StreamingPMBuilder(const std::string& workDir, size_t memoryBudget) ;
+
+	void setPercentWantedVertices(unsigned int p) { m_percentWantedVertices = p ; }
+	void setBuildMode(BuildMode mode) { m_buildMode = mode ; }
+	size_t getBytesPerFace() { return m_bytesPerFace ; }
+	void setBytesPerFace(size_t bytes) { m_bytesPerFace = bytes > 0 ? bytes : 1 ; }
+
+	unsigned int nbChunks() { return m_nbChunks ; }
+
+	bool build(const std::string& offFile) ;
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#include "StreamingPM.hpp"
+
+#endif
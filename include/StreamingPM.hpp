@@ -0,0 +1,664 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+
+#include "Algo/Import/import.h"
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Clé de position exacte (les positions sont réécrites avec une précision suffisante
+ * pour être relues à l'identique)
+ */
+struct PositionKey
+{
+	float x, y, z ;
+	bool operator<(const PositionKey& k) const
+	{
+		if(x != k.x) return x < k.x ;
+		if(y != k.y) return y < k.y ;
+		return z < k.z ;
+	}
+} ;
+
+/*
+ * Racine d'un morceau (sommet de son front grossier), écrite pour la passe de couture
+ * (fichier .roots : nombre de racines et de triangles, racines, puis triangles en
+ * indices de racines)
+ */
+struct RootRecord
+{
+	float position[3] ;
+	unsigned int node ;     //Noeud du morceau
+	unsigned int seam ;     //Sommet de couture, commun à plusieurs morceaux
+} ;
+
+template <typename PFP>
+StreamingPMBuilder<PFP>::StreamingPMBuilder(const std::string& workDir, size_t memoryBudget) :
+	m_workDir(workDir), m_memoryBudget(memoryBudget), m_percentWantedVertices(10),
+	m_buildMode(BUILD_SERIAL), m_bytesPerFace(DEFAULT_BYTES_PER_FACE), m_nbVertices(0), m_nbFaces(0), m_nbChunks(0)
+{}
+
+template <typename PFP>
+std::string StreamingPMBuilder<PFP>::chunkFile(unsigned int c, const std::string& ext)
+{
+	std::stringstream ss ;
+	ss << m_workDir << "/chunk_" << c << "." << ext ;
+	return ss.str() ;
+}
+
+template <typename PFP>
+unsigned int StreamingPMBuilder<PFP>::cellOf(const VEC3& p)
+{
+	unsigned int c[3] ;
+	for(unsigned int i = 0 ; i < 3 ; ++i)
+	{
+		REAL extent = m_max[i] - m_min[i] ;
+		REAL t = extent > REAL(0) ? (p[i] - m_min[i]) / extent : REAL(0) ;
+		int k = int(t * FINE_RES) ;
+		if(k < 0) k = 0 ;
+		if(k >= int(FINE_RES)) k = FINE_RES - 1 ;
+		c[i] = k ;
+	}
+	return c[0] + FINE_RES * (c[1] + FINE_RES * c[2]) ;
+}
+
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::readHeader(std::ifstream& in)
+{
+	std::string line ;
+	std::getline(in, line) ;
+	if(line.compare(0, 3, "OFF") != 0)
+		return false ;
+	do
+	{
+		if(!std::getline(in, line))
+			return false ;
+	} while(line.empty() || line[0] == '#') ;
+	std::stringstream ss(line) ;
+	unsigned int nbEdges ;
+	ss >> m_nbVertices >> m_nbFaces >> nbEdges ;
+	return !ss.fail() ;
+}
+
+/*
+ * Lit une face et la découpe en éventail de triangles (indices globaux, 3 par triangle)
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::readFace(std::ifstream& in, std::vector<unsigned int>& face)
+{
+	face.clear() ;
+	std::string line ;
+	do
+	{
+		if(!std::getline(in, line))
+			return false ;
+	} while(line.empty() || line[0] == '#') ;
+	std::stringstream ss(line) ;
+	unsigned int n, v0, prev, v ;
+	ss >> n >> v0 >> prev ;
+	for(unsigned int i = 2 ; i < n && ss >> v ; ++i)
+	{
+		if(v0 >= m_nbVertices || prev >= m_nbVertices || v >= m_nbVertices)
+			return false ;
+		face.push_back(v0) ;
+		face.push_back(prev) ;
+		face.push_back(v) ;
+		prev = v ;
+	}
+	return true ;
+}
+
+/*
+ * Passe 1 : boîte englobante et copie binaire des positions (projetée ensuite)
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::streamVertices(const std::string& offFile)
+{
+	std::ifstream in(offFile.c_str()) ;
+	if(!in.good() || !readHeader(in))
+	{
+		CGoGNerr << "streaming build: " << offFile << " is not a valid OFF file" << CGoGNendl ;
+		return false ;
+	}
+
+	std::ofstream out(positionsFile().c_str(), std::ios::binary) ;
+	if(!out.good())
+		return false ;
+
+	std::string line ;
+	for(unsigned int i = 0 ; i < m_nbVertices ; ++i)
+	{
+		do
+		{
+			if(!std::getline(in, line))
+				return false ;
+		} while(line.empty() || line[0] == '#') ;
+		std::stringstream ss(line) ;
+		float p[3] ;
+		ss >> p[0] >> p[1] >> p[2] ;
+		out.write(reinterpret_cast<const char*>(p), sizeof(p)) ;
+		for(unsigned int k = 0 ; k < 3 ; ++k)
+		{
+			if(i == 0 || p[k] < m_min[k]) m_min[k] = p[k] ;
+			if(i == 0 || p[k] > m_max[k]) m_max[k] = p[k] ;
+		}
+	}
+	return out.good() ;
+}
+
+/*
+ * Passe 2 : nombre de triangles par cellule de la grille fine, puis découpage
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::countFaces(const std::string& offFile)
+{
+	MappedFile positions ;
+	if(!positions.open(positionsFile()))
+		return false ;
+	const float* pos = reinterpret_cast<const float*>(positions.data()) ;
+
+	std::ifstream in(offFile.c_str()) ;
+	if(!readHeader(in))
+		return false ;
+	std::string line ;
+	for(unsigned int i = 0 ; i < m_nbVertices ; ++i)
+	{
+		do std::getline(in, line) ; while(line.empty() || line[0] == '#') ;
+	}
+
+	m_cellFaces.assign(FINE_RES * FINE_RES * FINE_RES, 0) ;
+	std::vector<unsigned int> face ;
+	for(unsigned int i = 0 ; i < m_nbFaces ; ++i)
+	{
+		if(!readFace(in, face))
+			return false ;
+		for(unsigned int t = 0 ; t < face.size() ; t += 3)
+		{
+			VEC3 centroid(0, 0, 0) ;
+			for(unsigned int k = 0 ; k < 3 ; ++k)
+				centroid += VEC3(pos[3*face[t+k]], pos[3*face[t+k]+1], pos[3*face[t+k]+2]) ;
+			++m_cellFaces[cellOf(centroid / REAL(3))] ;
+		}
+	}
+	partition() ;
+	return true ;
+}
+
+/*
+ * Regroupement des cellules dans l'ordre de Morton en morceaux respectant le budget
+ * selon l'estimation courante de la mémoire par face
+ */
+template <typename PFP>
+void StreamingPMBuilder<PFP>::partition()
+{
+	const unsigned int nbCells = FINE_RES * FINE_RES * FINE_RES ;
+	size_t facesPerChunk = m_memoryBudget / m_bytesPerFace ;
+	if(facesPerChunk == 0)
+		facesPerChunk = 1 ;
+
+	m_chunkOfCell.assign(nbCells, 0) ;
+	m_nbChunks = 0 ;
+	size_t current = 0 ;
+	for(unsigned int code = 0 ; code < nbCells ; ++code)
+	{
+		/*Décodage de Morton : bits entrelacés x, y, z*/
+		unsigned int c[3] = { 0, 0, 0 } ;
+		for(unsigned int b = 0 ; (1u << b) < FINE_RES ; ++b)
+			for(unsigned int k = 0 ; k < 3 ; ++k)
+				c[k] |= ((code >> (3*b + k)) & 1u) << b ;
+		unsigned int cell = c[0] + FINE_RES * (c[1] + FINE_RES * c[2]) ;
+
+		if(current > 0 && current + m_cellFaces[cell] > facesPerChunk)
+		{
+			++m_nbChunks ;
+			current = 0 ;
+		}
+		m_chunkOfCell[cell] = m_nbChunks ;
+		current += m_cellFaces[cell] ;
+	}
+	++m_nbChunks ;
+}
+
+/*
+ * Ajoute le tampon au fichier du morceau puis le libère
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::flushChunk(unsigned int c, std::vector<unsigned int>& buffer, size_t& buffered)
+{
+	if(buffer.empty())
+		return true ;
+	FILE* f = fopen(chunkFile(c, "faces").c_str(), "ab") ;
+	if(!f)
+		return false ;
+	bool ok = fwrite(&buffer[0], sizeof(unsigned int), buffer.size(), f) == buffer.size() ;
+	fclose(f) ;
+	buffered -= buffer.size() ;
+	std::vector<unsigned int>().swap(buffer) ;
+	return ok ;
+}
+
+/*
+ * Passe 3 : écriture des triangles de chaque morceau dans son fichier et marquage des
+ * sommets de couture (utilisés par un triangle d'un autre morceau que le leur)
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::distributeFaces(const std::string& offFile)
+{
+	MappedFile positions ;
+	MappedFile seam ;
+	if(!positions.open(positionsFile()) || !seam.create(seamFile(), m_nbVertices))
+		return false ;
+	const float* pos = reinterpret_cast<const float*>(positions.data()) ;
+	char* seamFlags = seam.writableData() ;
+
+	std::ifstream in(offFile.c_str()) ;
+	if(!readHeader(in))
+		return false ;
+	std::string line ;
+	for(unsigned int i = 0 ; i < m_nbVertices ; ++i)
+	{
+		do std::getline(in, line) ; while(line.empty() || line[0] == '#') ;
+	}
+
+	for(unsigned int c = 0 ; c < m_nbChunks ; ++c)
+		std::remove(chunkFile(c, "faces").c_str()) ;
+
+	//Un tampon par morceau, vidé dès qu'il atteint FLUSH_FACES triangles ; au total,
+	//les tampons ne dépassent pas leur part du budget (tous vidés au-delà)
+	size_t maxBuffered = std::max(size_t(3 * FLUSH_FACES), m_memoryBudget / BUFFER_SHARE / sizeof(unsigned int)) ;
+	size_t buffered = 0 ;
+	std::vector< std::vector<unsigned int> > buffers(m_nbChunks) ;
+	std::vector<unsigned int> face ;
+	for(unsigned int i = 0 ; i < m_nbFaces ; ++i)
+	{
+		if(!readFace(in, face))
+			return false ;
+		for(unsigned int t = 0 ; t < face.size() ; t += 3)
+		{
+			VEC3 centroid(0, 0, 0) ;
+			for(unsigned int k = 0 ; k < 3 ; ++k)
+				centroid += VEC3(pos[3*face[t+k]], pos[3*face[t+k]+1], pos[3*face[t+k]+2]) ;
+			unsigned int chunk = m_chunkOfCell[cellOf(centroid / REAL(3))] ;
+			for(unsigned int k = 0 ; k < 3 ; ++k)
+			{
+				unsigned int v = face[t+k] ;
+				VEC3 p(pos[3*v], pos[3*v+1], pos[3*v+2]) ;
+				if(m_chunkOfCell[cellOf(p)] != chunk)
+					seamFlags[v] = 1 ;
+				buffers[chunk].push_back(v) ;
+			}
+			buffered += 3 ;
+
+			/*Vidage du seul tampon modifié, ou de tous si leur part du budget est atteinte*/
+			if(buffers[chunk].size() >= 3 * FLUSH_FACES && !flushChunk(chunk, buffers[chunk], buffered))
+				return false ;
+			if(buffered > maxBuffered)
+			{
+				for(unsigned int c = 0 ; c < m_nbChunks ; ++c)
+				{
+					if(!flushChunk(c, buffers[c], buffered))
+						return false ;
+				}
+			}
+		}
+	}
+	for(unsigned int c = 0 ; c < m_nbChunks ; ++c)
+	{
+		if(!flushChunk(c, buffers[c], buffered))
+			return false ;
+	}
+	return true ;
+}
+
+/*
+ * Construction de la hiérarchie d'un morceau : carte locale, sommets de couture
+ * verrouillés, forêt écrite sur disque puis libérée
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::buildChunk(unsigned int c, unsigned long long inputHash, unsigned int& nbFaces)
+{
+	std::remove(chunkFile(c, "vdpm").c_str()) ;
+	std::remove(chunkFile(c, "roots").c_str()) ;
+	nbFaces = 0 ;
+
+	std::vector<unsigned int> triangles ;
+	{
+		MappedFile faces ;
+		if(!faces.open(chunkFile(c, "faces")))
+			return true ;	//Morceau vide
+		const unsigned int* t = reinterpret_cast<const unsigned int*>(faces.data()) ;
+		triangles.assign(t, t + faces.size() / sizeof(unsigned int)) ;
+	}
+	nbFaces = triangles.size() / 3 ;
+
+	std::vector<unsigned int> globals(triangles) ;
+	std::sort(globals.begin(), globals.end()) ;
+	globals.erase(std::unique(globals.begin(), globals.end()), globals.end()) ;
+
+	MappedFile positions ;
+	MappedFile seam ;
+	if(!positions.open(positionsFile()) || !seam.open(seamFile()))
+		return false ;
+	const float* pos = reinterpret_cast<const float*>(positions.data()) ;
+	const char* seamFlags = seam.data() ;
+
+	/*Maillage local au format OFF et table des indices globaux*/
+	std::string offFile = chunkFile(c, "off") ;
+	std::map<PositionKey, bool> seamOfPosition ;
+	unsigned int nbSeam = 0 ;
+	{
+		std::ofstream out(offFile.c_str()) ;
+		std::ofstream ids(chunkFile(c, "ids").c_str(), std::ios::binary) ;
+		out << "OFF" << std::endl << globals.size() << " " << triangles.size() / 3 << " 0" << std::endl ;
+		out << std::setprecision(9) ;
+		for(unsigned int i = 0 ; i < globals.size() ; ++i)
+		{
+			unsigned int v = globals[i] ;
+			PositionKey k = { pos[3*v], pos[3*v+1], pos[3*v+2] } ;
+			out << k.x << " " << k.y << " " << k.z << std::endl ;
+			bool& s = seamOfPosition[k] ;
+			s = s || seamFlags[v] != 0 ;
+			if(seamFlags[v]) ++nbSeam ;
+		}
+		for(unsigned int t = 0 ; t < triangles.size() ; t += 3)
+		{
+			out << "3" ;
+			for(unsigned int k = 0 ; k < 3 ; ++k)
+				out << " " << (std::lower_bound(globals.begin(), globals.end(), triangles[t+k]) - globals.begin()) ;
+			out << std::endl ;
+		}
+		ids.write(reinterpret_cast<const char*>(&globals[0]), globals.size() * sizeof(unsigned int)) ;
+	}
+	std::vector<unsigned int>().swap(triangles) ;
+	std::vector<unsigned int>().swap(globals) ;
+
+	MAP map ;
+	std::vector<std::string> attrNames ;
+	if(!Algo::Surface::Import::importMesh<PFP>(map, offFile.c_str(), attrNames))
+	{
+		CGoGNerr << "streaming build: could not import chunk " << c << CGoGNendl ;
+		return false ;
+	}
+	std::remove(offFile.c_str()) ;
+	VertexAttribute<VEC3> position = map.template getAttribute<VEC3, VERTEX>(attrNames[0]) ;
+
+	CellMarker<VERTEX> locked(map) ;
+	TraversorV<MAP> trav(map) ;
+	for(Dart d = trav.begin(); d != trav.end(); d = trav.next())
+	{
+		PositionKey k = { position[d][0], position[d][1], position[d][2] } ;
+		std::map<PositionKey, bool>::iterator it = seamOfPosition.find(k) ;
+		if(it != seamOfPosition.end() && it->second)
+			locked.mark(d) ;
+	}
+	seamOfPosition.clear() ;
+
+	DartMarker inactive(map) ;
+	Geom::BoundingBox<VEC3> bb = Algo::Geometry::computeBoundingBox<PFP>(map, position) ;
+	VDProgressiveMesh<PFP>* pmesh = new VDProgressiveMesh<PFP>(map, inactive, position, bb) ;
+	pmesh->setBuildMode(m_buildMode) ;
+	pmesh->setCollapseOrdering(ORDER_LAZY_QUEUE) ;
+	pmesh->setLockedVertices(&locked) ;
+	pmesh->createPM(m_percentWantedVertices) ;
+
+	unsigned long long key = pmesh->hierarchyKey(fnv1aValue(c, inputHash), m_percentWantedVertices) ;
+	bool ok = pmesh->saveHierarchy(chunkFile(c, "vdpm"), key)
+	       && writeRoots(c, map, inactive, locked, *pmesh, attrNames[0]) ;
+	delete pmesh ;
+
+	std::remove(chunkFile(c, "faces").c_str()) ;
+	CGoGNout << "  chunk " << c << " : " << nbSeam << " seam vertices" << CGoGNendl ;
+	return ok ;
+}
+
+/*
+ * Front grossier du morceau : ses sommets (racines de la forêt, avec leur noeud) et
+ * ses triangles actifs
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::writeRoots(unsigned int c, MAP& map, DartMarker& inactive, CellMarker<VERTEX>& locked,
+                                         VDProgressiveMesh<PFP>& pmesh, const std::string& positionName)
+{
+	VertexAttribute<VEC3> position = map.template getAttribute<VEC3, VERTEX>(positionName) ;
+	std::map<unsigned int, unsigned int> rootOfVertex ;	//Ligne du sommet -> racine
+	std::vector<RootRecord> roots ;
+	std::vector<unsigned int> triangles ;
+	for(Dart d = map.begin(); d != map.end(); map.next(d))
+	{
+		if(inactive.isMarked(d) || d.index != std::min(d.index, std::min(map.phi1(d).index, map.phi_1(d).index)))
+			continue ;
+		Dart face[3] = { d, map.phi1(d), map.phi_1(d) } ;
+		for(unsigned int k = 0 ; k < 3 ; ++k)
+		{
+			unsigned int v = map.template getEmbedding<VERTEX>(face[k]) ;
+			std::map<unsigned int, unsigned int>::iterator it = rootOfVertex.find(v) ;
+			if(it == rootOfVertex.end())
+			{
+				RootRecord r ;
+				for(unsigned int i = 0 ; i < 3 ; ++i)
+					r.position[i] = position[face[k]][i] ;
+				r.node = NO_NODE ;
+				r.seam = locked.isMarked(face[k]) ? 1 : 0 ;
+				it = rootOfVertex.insert(std::make_pair(v, (unsigned int)roots.size())).first ;
+				roots.push_back(r) ;
+			}
+			triangles.push_back(it->second) ;
+		}
+	}
+	const NodePool& nodes = pmesh.getNodes() ;
+	for(unsigned int n = 0 ; n < nodes.size() ; ++n)
+	{
+		if(!nodes.isActive(n))
+			continue ;
+		std::map<unsigned int, unsigned int>::iterator it = rootOfVertex.find(nodes.getVertex(n)) ;
+		if(it != rootOfVertex.end())
+			roots[it->second].node = n ;
+	}
+
+	std::ofstream out(chunkFile(c, "roots").c_str(), std::ios::binary) ;
+	unsigned int sizes[2] = { (unsigned int)roots.size(), (unsigned int)(triangles.size() / 3) } ;
+	out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes)) ;
+	if(!roots.empty())
+		out.write(reinterpret_cast<const char*>(&roots[0]), roots.size() * sizeof(RootRecord)) ;
+	if(!triangles.empty())
+		out.write(reinterpret_cast<const char*>(&triangles[0]), triangles.size() * sizeof(unsigned int)) ;
+	return out.good() ;
+}
+
+/*
+ * Hiérarchie de chaque morceau. Le pic de mémoire est mesuré après le premier morceau
+ * non vide : au-delà du budget, l'estimation par face est corrigée du dépassement et
+ * l'entrée redécoupée avant de reprendre (une seule fois)
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::buildChunks(const std::string& offFile, unsigned long long inputHash)
+{
+	bool measured = false ;
+	unsigned int c = 0 ;
+	while(c < m_nbChunks)
+	{
+		unsigned int nbFaces = 0 ;
+		if(!buildChunk(c, inputHash, nbFaces))
+			return false ;
+		++c ;
+		if(measured || nbFaces == 0)
+			continue ;
+		measured = true ;
+		size_t peak = peakMemory() ;
+		if(peak <= m_memoryBudget)
+			continue ;
+		m_bytesPerFace = size_t(double(m_bytesPerFace) * double(peak) / double(m_memoryBudget)) + 1 ;
+		CGoGNout << "  peak memory " << peak / (1024 * 1024) << " MB over budget, "
+		         << m_bytesPerFace << " bytes per face, repartitioning.." << CGoGNflush ;
+		partition() ;
+		if(!distributeFaces(offFile))
+			return false ;
+		CGoGNout << "..done (" << m_nbChunks << " chunks)" << CGoGNendl ;
+		c = 0 ;
+	}
+	return true ;
+}
+
+/*
+ * Passe de couture : les fronts grossiers des morceaux, réunis par leurs sommets de
+ * couture (positions identiques, jamais contractés), forment top.off ; sa hiérarchie
+ * construite sans verrou donne les niveaux supérieurs de la forêt
+ */
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::mergeSeams(unsigned long long& key)
+{
+	std::vector<float> positions ;
+	std::vector<unsigned int> triangles ;
+	{
+		std::map<PositionKey, unsigned int> seamVertex ;
+		std::ofstream rootsOut((m_workDir + "/top.roots").c_str()) ;
+		rootsOut << "# top.off vertex, chunk, node" << std::endl ;
+		std::vector<unsigned int> merged ;
+		for(unsigned int c = 0 ; c < m_nbChunks ; ++c)
+		{
+			MappedFile file ;
+			if(!file.open(chunkFile(c, "roots")))
+				continue ;	//Morceau vide
+			const unsigned int* sizes = reinterpret_cast<const unsigned int*>(file.data()) ;
+			if(file.size() != 2 * sizeof(unsigned int) + sizes[0] * sizeof(RootRecord) + 3 * sizes[1] * sizeof(unsigned int))
+				return false ;
+			const RootRecord* roots = reinterpret_cast<const RootRecord*>(sizes + 2) ;
+			const unsigned int* t = reinterpret_cast<const unsigned int*>(roots + sizes[0]) ;
+
+			merged.resize(sizes[0]) ;
+			for(unsigned int i = 0 ; i < sizes[0] ; ++i)
+			{
+				const RootRecord& r = roots[i] ;
+				unsigned int v = positions.size() / 3 ;
+				if(r.seam)
+				{
+					PositionKey k = { r.position[0], r.position[1], r.position[2] } ;
+					std::pair<std::map<PositionKey, unsigned int>::iterator, bool> it = seamVertex.insert(std::make_pair(k, v)) ;
+					v = it.first->second ;
+				}
+				if(v == positions.size() / 3)
+					positions.insert(positions.end(), r.position, r.position + 3) ;
+				merged[i] = v ;
+				rootsOut << v << " " << c << " " << r.node << std::endl ;
+			}
+			for(unsigned int i = 0 ; i < 3 * sizes[1] ; ++i)
+			{
+				if(t[i] >= sizes[0])
+					return false ;
+				triangles.push_back(merged[t[i]]) ;
+			}
+		}
+		if(!rootsOut.good())
+			return false ;
+	}
+
+	{
+		std::ofstream out(topFile().c_str()) ;
+		out << "OFF" << std::endl << positions.size() / 3 << " " << triangles.size() / 3 << " 0" << std::endl ;
+		out << std::setprecision(9) ;
+		for(unsigned int i = 0 ; i < positions.size() ; i += 3)
+			out << positions[i] << " " << positions[i+1] << " " << positions[i+2] << std::endl ;
+		for(unsigned int i = 0 ; i < triangles.size() ; i += 3)
+			out << "3 " << triangles[i] << " " << triangles[i+1] << " " << triangles[i+2] << std::endl ;
+		if(!out.good())
+			return false ;
+	}
+	CGoGNout << "  top level : " << positions.size() / 3 << " vertices, " << triangles.size() / 3 << " faces" << CGoGNendl ;
+	std::vector<float>().swap(positions) ;
+	std::vector<unsigned int>().swap(triangles) ;
+
+	MAP map ;
+	std::vector<std::string> attrNames ;
+	if(!Algo::Surface::Import::importMesh<PFP>(map, topFile().c_str(), attrNames))
+	{
+		CGoGNerr << "streaming build: could not import " << topFile() << CGoGNendl ;
+		return false ;
+	}
+	VertexAttribute<VEC3> position = map.template getAttribute<VEC3, VERTEX>(attrNames[0]) ;
+	DartMarker inactive(map) ;
+	Geom::BoundingBox<VEC3> bb = Algo::Geometry::computeBoundingBox<PFP>(map, position) ;
+	VDProgressiveMesh<PFP>* pmesh = new VDProgressiveMesh<PFP>(map, inactive, position, bb) ;
+	pmesh->setBuildMode(m_buildMode) ;
+	pmesh->setCollapseOrdering(ORDER_LAZY_QUEUE) ;
+	pmesh->createPM(m_percentWantedVertices) ;
+	key = pmesh->hierarchyKey(hashFile(topFile()), m_percentWantedVertices) ;
+	bool ok = pmesh->saveHierarchy(topFile() + ".vdpm", key) ;
+	delete pmesh ;
+	return ok ;
+}
+
+template <typename PFP>
+bool StreamingPMBuilder<PFP>::build(const std::string& offFile)
+{
+	CGoGNout << "  streaming vertices.." << CGoGNflush ;
+	if(!streamVertices(offFile))
+		return false ;
+	CGoGNout << "..done (" << m_nbVertices << " vertices, " << m_nbFaces << " faces)" << CGoGNendl ;
+
+	CGoGNout << "  partitioning.." << CGoGNflush ;
+	if(!countFaces(offFile) || !distributeFaces(offFile))
+		return false ;
+	CGoGNout << "..done (" << m_nbChunks << " chunks)" << CGoGNendl ;
+
+	unsigned long long inputHash = hashFile(offFile) ;
+	if(!buildChunks(offFile, inputHash))
+		return false ;
+	std::vector<unsigned int>().swap(m_cellFaces) ;
+	std::vector<unsigned int>().swap(m_chunkOfCell) ;
+
+	unsigned long long topKey = 0 ;
+	if(!mergeSeams(topKey))
+		return false ;
+
+	/*Manifeste : niveaux supérieurs (maillage, cache et sa clé), puis caches des morceaux*/
+	std::ofstream manifest((m_workDir + "/manifest.txt").c_str()) ;
+	manifest << "VDPM streaming " << CACHE_VERSION << " " << m_nbChunks << " " << m_percentWantedVertices << std::endl ;
+	manifest << "top " << topFile() << " " << topFile() << ".vdpm " << topKey << std::endl ;
+	for(unsigned int c = 0 ; c < m_nbChunks ; ++c)
+	{
+		if(fileSize(chunkFile(c, "vdpm")) > 0)
+			manifest << "chunk " << c << " " << chunkFile(c, "vdpm") << " " << chunkFile(c, "roots") << std::endl ;
+	}
+	CGoGNout << "  peak memory " << peakMemory() / (1024 * 1024) << " MB (budget " << m_memoryBudget / (1024 * 1024) << " MB)" << CGoGNendl ;
+	return manifest.good() ;
+}
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
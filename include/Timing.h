@@ -0,0 +1,118 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* version 0.1                                                                  *
+* Copyright (C) 2009-2012, IGG Team, LSIIT, University of Strasbourg           *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef __VDPM_TIMING_H__
+#define __VDPM_TIMING_H__
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace CGoGN
+{
+
+namespace Algo
+{
+
+namespace Surface
+{
+
+namespace VDPMesh
+{
+
+/*
+ * Temps écoulé (horloge murale) en secondes depuis une origine arbitraire
+ */
+inline double wallClock()
+{
+#ifdef WIN32
+	LARGE_INTEGER freq, count ;
+	QueryPerformanceFrequency(&freq) ;
+	QueryPerformanceCounter(&count) ;
+	return double(count.QuadPart) / double(freq.QuadPart) ;
+#else
+	struct timeval tv ;
+	gettimeofday(&tv, NULL) ;
+	return double(tv.tv_sec) + double(tv.tv_usec) * 1e-6 ;
+#endif
+}
+
+/*
+ * Budget d'une tranche de mise à jour du raffinement : nombre maximal de
+ * transformations (VSplit ou contractions) et/ou durée maximale. 0 : illimité.
+ */
+struct RefinementBudget
+{
+	unsigned int maxOperations ;
+	double maxSeconds ;
+
+	explicit RefinementBudget(unsigned int operations = 0, double seconds = 0.)
+		: maxOperations(operations), maxSeconds(seconds)
+	{}
+} ;
+
+/*
+ * Décompte d'une tranche en cours. L'horloge n'est consultée que toutes les
+ * CHECK_PERIOD étapes pour que le contrôle reste négligeable devant le parcours.
+ */
+class RefinementSlice
+{
+public:
+	static const unsigned int CHECK_PERIOD = 32 ;
+
+	RefinementSlice(const RefinementBudget& budget)
+		: m_maxOperations(budget.maxOperations), m_operations(0), m_steps(0),
+		  m_deadline(budget.maxSeconds > 0. ? wallClock() + budget.maxSeconds : 0.), m_exhausted(false)
+	{}
+
+	void operation() { ++m_operations ; }
+	unsigned int operations() const { return m_operations ; }
+
+	bool exhausted()
+	{
+		if(m_exhausted)
+			return true ;
+		if(m_maxOperations > 0 && m_operations >= m_maxOperations)
+			m_exhausted = true ;
+		else if(m_deadline > 0. && ++m_steps % CHECK_PERIOD == 0 && wallClock() >= m_deadline)
+			m_exhausted = true ;
+		return m_exhausted ;
+	}
+
+private:
+	unsigned int m_maxOperations ;
+	unsigned int m_operations ;
+	unsigned int m_steps ;
+	double m_deadline ;
+	bool m_exhausted ;
+} ;
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
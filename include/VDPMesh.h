@@ -31,17 +31,40 @@
 #include "Algo/Decimation/geometryPredictor.h"
 #include "Algo/Decimation/colorPerVertexApproximator.h"
 #include "Algo/Geometry/boundingbox.h"
+#include "Algo/Geometry/normal.h"
+#include "Topology/generic/cellmarker.h"
 
+#ifndef VDPMESH_HEADLESS
 #include "Utils/drawer.h"
+#endif
 
 #include <iterator>
 #include <vector>
-#include <stack>
 #include <list>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "Utils/quantization.h"
 #include "Node.h"
+#include "ActiveFront.h"
 #include "Box.h"
+#include "InterestRegions.h"
+#include "BoxPredictor.h"
+#include "FrontChanges.h"
+#include "NodeBounds.h"
+#include "ViewCriterion.h"
+#include "LODFalloff.h"
+#include "Timing.h"
+#include "Profiler.h"
+#include "CollapseQueue.h"
+#include "HierarchyCache.h"
 
 namespace CGoGN
 {
@@ -55,6 +78,29 @@ namespace Surface
 namespace VDPMesh
 {
 
+/*
+ * Mode de construction de la hiérarchie :
+ *  - BUILD_SERIAL : une contraction à la fois, ordonnée par le sélecteur CGoGN
+ *  - BUILD_PARALLEL : par tours d'ensembles indépendants de contractions
+ */
+enum BuildMode { BUILD_SERIAL, BUILD_PARALLEL } ;
+
+/*
+ * Ordonnancement des contractions en mode séquentiel :
+ *  - ORDER_SELECTOR : sélecteur CGoGN (EdgeSelector_Length)
+ *  - ORDER_LAZY_QUEUE : file de priorité propre à VDPMesh, à invalidation paresseuse
+ */
+enum CollapseOrdering { ORDER_SELECTOR, ORDER_LAZY_QUEUE } ;
+
+/*
+ * Critère de raffinement du front :
+ *  - CRITERION_BOX : raffinement complet dans la boîte d'intérêt
+ *  - CRITERION_VIEW : pyramide de vue, faces arrière et erreur projetée (ViewCriterion)
+ *  - CRITERION_GRADED : erreur tolérée croissante avec la distance à la boîte et aux
+ *    régions d'intérêt (politique de décroissance, voir LODFalloff.h)
+ */
+enum RefinementCriterion { CRITERION_BOX, CRITERION_VIEW, CRITERION_GRADED } ;
+
 template <typename PFP>
 class VDProgressiveMesh
 {
@@ -78,8 +124,12 @@ private:
 
 	bool m_initOk ;
     
-    //Liste des noeuds actifs (front de la forêt)
-    std::list<Node*> m_active_nodes;
+    //Noeuds de la forêt et VSplit associés (indicés par NodePool::getVSplit)
+    NodePool m_nodes;
+    std::vector<VSplit> m_splits;
+
+    //Noeuds actifs (front de la forêt)
+    ActiveFront m_active_nodes;
 
     //Attribut de sommet Node
     typedef NoMathIOAttribute<Algo::Surface::VDPMesh::NodeInfo> EmbNode;
@@ -88,9 +138,181 @@ private:
     //Boite englobante dans laquelle le modèle est plus affiné
     Box* m_bb;
 
+    //Régions d'intérêt supplémentaires (boîtes et sphères), affinées comme la boîte
+    InterestRegions m_regions;
+
+    //Sphères englobantes des sous-arbres (indicées par noeud) et hiérarchie des racines
+    std::vector<BoundingSphere> m_spheres;
+    RootHierarchy m_rootHierarchy;
+
+    //Cônes des normales (calculés à la construction) et erreurs géométriques des sous-arbres
+    std::vector<NormalCone> m_cones;
+    std::vector<float> m_errors;
+
+    //Normale du sommet de chaque noeud, calculée à la construction sur le maillage où il apparaît
+    std::vector<VEC3> m_nodeNormals;
+
+    //Critère de raffinement et point de vue courant
+    RefinementCriterion m_criterion;
+    ViewCriterion m_view;
+    bool m_criterionChanged;    //Point de vue ou régions modifiés : le front entier est à réévaluer
+
+    /*
+     * Tests "noeud à raffiner" des critères, passés en paramètre template aux parcours
+     * du front pour que le test soit résolu à la compilation dans la boucle
+     */
+    struct RegionTest {
+        VDProgressiveMesh& pm;
+        RegionTest(VDProgressiveMesh& m) : pm(m) {}
+        bool operator()(unsigned int n) const {
+            const VEC3& p = pm.positionsTable[pm.m_nodes.getVertex(n)];
+            return pm.m_bb->contains(p) || pm.m_regions.contains(p);
+        }
+    };
+
+    struct ViewTest {
+        VDProgressiveMesh& pm;
+        ViewTest(VDProgressiveMesh& m) : pm(m) {}
+        bool operator()(unsigned int n) const {
+            return pm.m_view.needsRefinement(pm.m_spheres[n], pm.m_cones[n], pm.m_errors[n]);
+        }
+    };
+
+    //Raffinement gradué : erreur du noeud comparée à la tolérance à la distance de sa sphère
+    template <typename Falloff>
+    struct GradedTest {
+        VDProgressiveMesh& pm;
+        const Falloff& falloff;
+        GradedTest(VDProgressiveMesh& m, const Falloff& f) : pm(m), falloff(f) {}
+        bool operator()(unsigned int n) const {
+            const BoundingSphere& s = pm.m_spheres[n];
+            float range = falloff.maxDistance();
+            float d = pm.regionDistance(s.center, range + s.radius) - s.radius;
+            return pm.m_errors[n] > falloff.allowedError(std::max(0.0f, std::min(d, range)));
+        }
+    };
+
+    //Politique de décroissance choisie à l'exécution, parcours instanciés par politique
+    struct GradedSliceBase {
+        virtual ~GradedSliceBase() {}
+        virtual bool run(VDProgressiveMesh& pm, RefinementSlice& slice) = 0;
+        virtual void runParallel(VDProgressiveMesh& pm) = 0;
+    };
+
+    template <typename Falloff>
+    struct GradedSlice : public GradedSliceBase {
+        Falloff falloff;
+        GradedSlice(const Falloff& f) : falloff(f) {}
+        bool run(VDProgressiveMesh& pm, RefinementSlice& slice) {
+            return pm.runSlice(slice, GradedTest<Falloff>(pm, falloff));
+        }
+        void runParallel(VDProgressiveMesh& pm) {
+            pm.refineRounds(GradedTest<Falloff>(pm, falloff));
+        }
+    };
+
+    GradedSliceBase* m_graded;
+
+    //Boîte d'intérêt visée par la mise à jour précédente (éventuellement inachevée)
+    VEC3 m_lastBoxMin, m_lastBoxMax;
+    bool m_lastBoxValid;
+
+    //Changements du maillage notés pour l'affichage incrémental
+    bool m_trackChanges;
+    FrontChanges m_changes;
+
+    //Raffinement spéculatif devant la boîte : positions récentes et région anticipée
+    BoxPredictor m_predictor;
+    unsigned int m_prefetchRegion;  //NO_REGION sans spéculation en cours
+
+    //Travail en attente d'une mise à jour par tranches : parcours complet du front
+    //(curseur) et descente dans les sous-arbres de la région (pile, région cumulée)
+    bool m_scanPending;
+    unsigned int m_scanCursor;
+    std::vector<std::pair<unsigned int, bool> > m_pending;
+    UpdateRegion m_pendingRegion;
+
+    //Transformations voulues mais refusées par la topologie : raffinements résolus par
+    //forceRefine avant la convergence, simplifications (parents des paires) retentées
+    //à chaque région touchée
+    std::vector<unsigned int> m_blockedRefine;
+    std::vector<unsigned int> m_blockedCoarsen;
+
+    //Pile de forceRefine réutilisée d'un appel à l'autre ; m_forcePos donne la place
+    //d'un noeud dans la pile (NO_SLOT s'il n'y est pas) pour ne l'y mettre qu'une fois
+    std::vector<unsigned int> m_forcePile;
+    std::vector<unsigned int> m_forcePos;
+
     //DEBUG
     int m_height; //Hauteur de l'arbre le plus grand de la forêt
 
+    //Paramètres de construction
+    BuildMode m_buildMode;
+    unsigned int m_seed;    //Graine du départage des ex aequo (mode parallèle)
+    CollapseOrdering m_ordering;
+
+    //File des contractions et tampons de version des arêtes (indexés par brin)
+    CollapseQueue<REAL> m_queue;
+    std::vector<unsigned int> m_dartStamp;
+    unsigned int m_stamp;
+
+    //Sommets verrouillés : aucune contraction ne les touche (coutures du mode streaming)
+    CellMarker<VERTEX>* m_locked;
+
+    //Poids de la pénalité de hauteur (équilibrage des arbres), 0 pour la désactiver
+    REAL m_balanceWeight;
+
+    /*
+     * Candidat à la contraction évalué lors d'un tour de construction parallèle
+     */
+    struct CollapseCandidate {
+        Dart d;
+        REAL cost;
+        unsigned int key;   //Clé de départage déterministe
+        bool legal;
+
+        bool operator<(const CollapseCandidate& c) const {
+            if(cost != c.cost) return cost < c.cost;
+            if(key != c.key) return key < c.key;
+            return d.index < c.d.index;
+        }
+    };
+
+    void createSelector() ;
+    unsigned int collapseAndLink(Dart d, bool updateSelector) ;
+    void releaseSplits() ;
+    bool checkCache(const NodeRecord* records, unsigned int nbNodes, const unsigned int* inactiveDarts, unsigned int nbInactiveDarts,
+                    const UsedLines& darts, const UsedLines& vertices, const UsedLines& edges) ;
+
+    void computeBounds() ;
+    NormalCone vertexNormalCone(Dart d) ;
+    void regionChanged(const InterestRegion& region) ;
+    float regionDistance(const VEC3& p, float maxDistance) ;
+    template <typename Criterion> bool updateNode(unsigned int n, const Criterion& wanted) ;
+    void pushRegion(const UpdateRegion& region) ;
+    template <typename Criterion> bool processScan(RefinementSlice& slice, const Criterion& wanted) ;
+    template <typename Criterion> bool processPending(RefinementSlice& slice, const Criterion& wanted) ;
+    template <typename Criterion> bool processBlocked(RefinementSlice& slice, const Criterion& wanted) ;
+    template <typename Criterion> bool runSlice(RefinementSlice& slice, const Criterion& wanted) ;
+    bool runSlice(RefinementSlice& slice) ;
+    template <typename Criterion> void refineRounds(const Criterion& wanted) ;
+    void resetRefinementState() ;
+
+    Dart getOppositeLeftEdge(const VSplit& vs) ;
+    Dart getOppositeRightEdge(const VSplit& vs) ;
+    void createPMParallel(unsigned int& nbVertices, unsigned int nbWantedVertices) ;
+    void createPMQueue(unsigned int& nbVertices, unsigned int nbWantedVertices) ;
+
+    void fillQueue() ;
+    void pushEdge(Dart d) ;
+    void pushVertexEdges(Dart d) ;
+
+    REAL collapseCost(Dart d) ;
+    bool isCollapsible(Dart d) ;
+    unsigned int tieBreakKey(Dart d) ;
+    bool isNeighbourhoodMarked(Dart d, CellMarkerStore<VERTEX>& cm) ;
+    void markNeighbourhood(Dart d, CellMarkerStore<VERTEX>& cm) ;
+
 public:
 	VDProgressiveMesh(
 		MAP& map, DartMarker& inactive,
@@ -106,30 +328,111 @@ public:
 
 	void createPM(unsigned int percentWantedVertices) ;
 
+	bool restoreFullResolution() ;
+	void clearHierarchy() ;
+
+	BuildMode getBuildMode() { return m_buildMode ; }
+	void setBuildMode(BuildMode mode) { m_buildMode = mode ; }
+	unsigned int getSeed() { return m_seed ; }
+	void setSeed(unsigned int seed) { m_seed = seed ; }
+	CollapseOrdering getCollapseOrdering() { return m_ordering ; }
+	void setCollapseOrdering(CollapseOrdering ordering) { m_ordering = ordering ; }
+	void setLockedVertices(CellMarker<VERTEX>* locked) { m_locked = locked ; }
+	REAL getBalanceWeight() { return m_balanceWeight ; }
+	void setBalanceWeight(REAL weight) { m_balanceWeight = weight ; }
+
+	void getHeightDistribution(std::vector<unsigned int>& histogram) ;
+	void printHeightDistribution() ;
+
+	/*Mémoire occupée par la hiérarchie (octets alloués)*/
+	size_t getNodesMemory() { return m_nodes.memory() ; }
+	size_t getSplitsMemory() { return m_splits.capacity() * sizeof(VSplit) ; }
+	size_t getFrontMemory() { return m_active_nodes.memory() ; }
+	size_t getBoundsMemory() {
+		return m_spheres.capacity() * sizeof(BoundingSphere) + m_cones.capacity() * sizeof(NormalCone)
+			+ m_errors.capacity() * sizeof(float) + m_nodeNormals.capacity() * sizeof(VEC3) + m_rootHierarchy.memory() ;
+	}
+	void printMemoryUsage() ;
+
 	Algo::Surface::Decimation::EdgeSelector<PFP>* selector() { return m_selector ; }
 	std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>& approximators() { return m_approximators ; }
 
 	Box* getInterestBox() { return m_bb; }
 
-	void edgeCollapse(VSplit<PFP>* vs) ;
-	void vertexSplit(VSplit<PFP>* vs) ;
+	/*Régions d'intérêt supplémentaires, désignées par leur poignée*/
+	unsigned int addInterestBox(const VEC3& pos_min, const VEC3& pos_max) ;
+	unsigned int addInterestSphere(const VEC3& center, float radius) ;
+	void moveInterestBox(unsigned int region, const VEC3& pos_min, const VEC3& pos_max) ;
+	void moveInterestSphere(unsigned int region, const VEC3& center, float radius) ;
+	void removeInterestRegion(unsigned int region) ;
+	const InterestRegions& getInterestRegions() { return m_regions; }
+
+	/*
+	 * Suivi des changements du maillage (FrontChanges) : faces autour de chaque
+	 * transformation et noeuds entrés ou sortis du front, lus et effacés par l'appelant
+	 */
+	bool getChangeTracking() { return m_trackChanges; }
+	void setChangeTracking(bool b) ;
+	FrontChanges& getChanges() { return m_changes; }
+
+	float getPrefetchLookAhead() { return m_predictor.getLookAhead(); }
+	void setPrefetchLookAhead(float steps) { m_predictor.setLookAhead(steps); }
+	bool updatePrefetch(const RefinementBudget& budget);
+	//Relevé de la boîte d'intérêt pour la prédiction : à chaque déplacement demandé, et
+	//après BoxPredictor::REST_DELAY ms d'immobilité tant qu'une spéculation est en cours
+	void recordInterestBox() { m_predictor.record(m_bb->getPosMin(), m_bb->getPosMax()); }
+	bool isPrefetching() { return m_prefetchRegion != NO_REGION; }
+
+	RefinementCriterion getRefinementCriterion() { return m_criterion; }
+	void setRefinementCriterion(RefinementCriterion criterion) ;
+	const ViewCriterion& getView() { return m_view; }
+	void setView(const ViewCriterion& view) ;
+	template <typename Falloff> void setGradedFalloff(const Falloff& falloff) ;
+
+	unsigned long long hierarchyKey(unsigned long long meshHash, unsigned int percentWantedVertices) ;
+	bool saveHierarchy(const std::string& filename, unsigned long long key) ;
+	bool loadHierarchy(const std::string& filename, unsigned long long key) ;
+
+	void edgeCollapse(const VSplit& vs) ;
+	void vertexSplit(const VSplit& vs) ;
 
 	void coarsen() ;
 	void refine() ;
 
-	std::list<Node*>::iterator coarsen(Node* n) ;
-	std::list<Node*>::iterator refine(Node* n) ;
+	bool coarsen(unsigned int n) ;
+	bool refine(unsigned int n) ;
 
 	void updateRefinement();
-	std::list<Node*>::iterator forceRefine(Node* n);
+	bool updateRefinement(const RefinementBudget& budget);
+	void updateRefinement(const VEC3& previousMin, const VEC3& previousMax);
+	void updateRefinementParallel();
+	bool isRefinementConverged() { return !m_scanPending && m_pending.empty() && m_blockedRefine.empty(); }
+	//Abandonne l'état incrémental : la mise à jour suivante parcourt tout le front
+	void invalidateRefinement() { resetRefinementState(); }
+	bool forceRefine(unsigned int n);
+
+	bool searchChildActive(unsigned int noeud);
+	unsigned int searchParentActive(unsigned int noeud);
+
+private:
+	void pushForce(unsigned int n) ;
+	void recordStar(Dart d) ;
+	void popForce() ;
+
+public:
 
-	bool searchChildActive(Node* noeud);
-	std::list<Node*>::iterator searchParentActive(Node* noeud);
+	const NodePool& getNodes() { return m_nodes; }
+	const std::vector<VSplit>& getSplits() { return m_splits; }
+	const BoundingSphere& getBoundingSphere(unsigned int n) { return m_spheres[n]; }
+	const NormalCone& getNormalCone(unsigned int n) { return m_cones[n]; }
+	float getGeometricError(unsigned int n) { return m_errors[n]; }
+	const std::vector<VEC3>& getNodeNormals() { return m_nodeNormals; }
+	const ActiveFront& getFront() { return m_active_nodes; }
 
     /*DEBUG FUNCTIONS*/
     int getForestHeight() { return m_height; }
     void drawForest();
-    void drawTree(Node* node);
+    void drawTree(unsigned int node);
     void drawFront();
 } ;
 
@@ -42,7 +42,10 @@ VDProgressiveMesh<PFP>::VDProgressiveMesh(
 		VertexAttribute<typename PFP::VEC3>& position,
 		Geom::BoundingBox<typename PFP::VEC3> bb
 	) :
-	m_map(map), positionsTable(position), inactiveMarker(inactive), dartSelect(inactiveMarker), m_height(0)
+	m_map(map), positionsTable(position), inactiveMarker(inactive), dartSelect(inactiveMarker),
+	m_active_nodes(m_nodes), m_criterion(CRITERION_BOX), m_criterionChanged(false), m_graded(NULL), m_lastBoxValid(false), m_trackChanges(false), m_prefetchRegion(NO_REGION), m_scanPending(false), m_scanCursor(0), m_height(0),
+	m_buildMode(BUILD_SERIAL), m_seed(0), m_ordering(ORDER_SELECTOR), m_stamp(0),
+	m_locked(NULL), m_balanceWeight(0)
 {
 	CGoGNout << "  creating approximator .." << CGoGNflush ;
 	std::vector<VertexAttribute< typename PFP::VEC3>* > pos_v ;
@@ -53,12 +56,7 @@ VDProgressiveMesh<PFP>::VDProgressiveMesh(
 
 
 	CGoGNout << "  creating selector.." << CGoGNflush ;			
-    m_selector = new Algo::Surface::Decimation::EdgeSelector_Length<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
-	//m_selector = new Algo::Surface::Decimation::EdgeSelector_QEM<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
-	//m_selector = new Algo::Surface::Decimation::EdgeSelector_MapOrder<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
-	//m_selector = new Algo::Surface::Decimation::EdgeSelector_Random<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
-	//m_selector = new Algo::Surface::Decimation::EdgeSelector_MinDetail<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
-	//m_selector = new Algo::Surface::Decimation::EdgeSelector_Curvature<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
+	createSelector() ;
 	CGoGNout << "..done" << CGoGNendl ;
 
 	m_initOk = true ;
@@ -66,18 +64,14 @@ VDProgressiveMesh<PFP>::VDProgressiveMesh(
 	CGoGNout << "  initializing approximators.." << CGoGNflush ;
 	for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
 	CGoGNout << "..done" << CGoGNendl ;
-
-	CGoGNout << "  initializing selector.." << CGoGNflush ;
-	m_initOk = m_selector->init() ;
-    CGoGNout << "..done" << CGoGNendl ;
     
     noeud = m_map.template getAttribute<EmbNode, VERTEX>("noeud") ;
 	if(!noeud.isValid())
 		noeud = m_map.template addAttribute<EmbNode, VERTEX>("noeud") ;
 
-    CGoGNout << "  initializing drawer.." << CGoGNflush;
+    CGoGNout << "  initializing interest box.." << CGoGNflush;
     m_bb = new Box(bb);
-	m_bb->updateDrawer();
+    m_regions.setGrid(bb.min(), bb.max());
 	updateRefinement();
     CGoGNout << "..done" << CGoGNendl;
 }
@@ -85,21 +79,38 @@ VDProgressiveMesh<PFP>::VDProgressiveMesh(
 template <typename PFP>
 VDProgressiveMesh<PFP>::~VDProgressiveMesh()
 {
-	m_active_nodes.clear();
+	clearHierarchy();
     if(m_selector)
 		delete m_selector ;
 	for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
 		delete (*it) ;
 	delete m_bb;
+	delete m_graded;
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::createSelector()
+{
+    m_selector = new Algo::Surface::Decimation::EdgeSelector_Length<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
+	//m_selector = new Algo::Surface::Decimation::EdgeSelector_QEM<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
+	//m_selector = new Algo::Surface::Decimation::EdgeSelector_MapOrder<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
+	//m_selector = new Algo::Surface::Decimation::EdgeSelector_Random<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
+	//m_selector = new Algo::Surface::Decimation::EdgeSelector_MinDetail<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
+	//m_selector = new Algo::Surface::Decimation::EdgeSelector_Curvature<PFP>(m_map, positionsTable, m_approximators, dartSelect) ;
 }
 
 template <typename PFP>
 void VDProgressiveMesh<PFP>::addNodes() {
     TraversorV<MAP> trav(m_map);
     for(Dart d = trav.begin(); d!=trav.end(); d = trav.next()) {
-        noeud[d].node = new Node(NULL, true, m_map.template getEmbedding<VERTEX>(d), 0);
-        m_active_nodes.push_front(noeud[d].node);
-        noeud[d].node->setCurrentPosition(m_active_nodes.begin());
+        unsigned int n = m_nodes.addNode(NO_SPLIT, true, m_map.template getEmbedding<VERTEX>(d), 0);
+        noeud[d].node = n;
+        m_active_nodes.insert(n);
+        //Cône des normales des faces du maillage complet autour du sommet
+        m_cones.resize(m_nodes.size());
+        m_cones[n] = vertexNormalCone(d);
+        m_nodeNormals.resize(m_nodes.size());
+        m_nodeNormals[n] = Algo::Surface::Geometry::vertexNormal<PFP>(m_map, d, positionsTable);
     }
     m_height = 0;
 }
@@ -107,109 +118,529 @@ void VDProgressiveMesh<PFP>::addNodes() {
 template <typename PFP>
 void VDProgressiveMesh<PFP>::createPM(unsigned int percentWantedVertices)
 {
+	VDPM_TIMER(PHASE_CREATE_PM) ;
+	//Reconstruction : la carte est d'abord ramenée à sa résolution d'origine. Tant que la
+	//hiérarchie précédente n'est pas libérée, un échec la laisse intacte (front ramené
+	//aux feuilles, mis à jour entièrement à l'appel suivant)
+	if(m_nodes.size() > 0 && !restoreFullResolution()) {
+		CGoGNerr << "could not restore the full resolution mesh, hierarchy kept" << CGoGNendl ;
+		resetRefinementState() ;
+		return ;
+	}
+	if(!m_selector)
+		createSelector() ;
+
+	bool useSelector = m_buildMode != BUILD_PARALLEL && m_ordering != ORDER_LAZY_QUEUE ;
+	if(useSelector) {
+		//Le sélecteur CGoGN n'est initialisé que s'il est effectivement utilisé, sur la
+		//carte complète et avant la libération de la hiérarchie précédente
+		CGoGNout << "  initializing selector.." << CGoGNflush ;
+		m_initOk = m_selector->init() ;
+		if(!m_initOk) {
+			CGoGNerr << "selector initialization failed" << (m_nodes.size() > 0 ? ", hierarchy kept" : "") << CGoGNendl ;
+			resetRefinementState() ;
+			return ;
+		}
+		CGoGNout << "..done" << CGoGNendl ;
+	}
+
+	if(m_nodes.size() > 0) {
+		//Les tableaux de la hiérarchie sont vidés en conservant leur capacité
+		CGoGNout << "  releasing previous hierarchy.." << CGoGNflush ;
+		clearHierarchy() ;
+		CGoGNout << "..done" << CGoGNendl ;
+	}
+
 	unsigned int nbVertices = m_map.template getNbOrbits<VERTEX>() ;
 	unsigned int nbWantedVertices = nbVertices * percentWantedVertices / 100 ;
     
     CGoGNout << "  initializing nodes.." << CGoGNflush ;
+    //Une feuille par sommet puis un noeud interne par contraction
+    m_nodes.reserve(2 * nbVertices - nbWantedVertices);
+    m_splits.reserve(nbVertices - nbWantedVertices);
+    m_active_nodes.reserve(nbVertices);
     addNodes();
 	CGoGNout << "..done" << CGoGNendl ;
 	
     CGoGNout << "  creating PM (" << nbVertices << " vertices).." << /* flush */ CGoGNflush ;
     
-	bool finished = false ;
-	Dart d ;
-	while(!finished)
-	{
-		if(!m_selector->nextEdge(d))
-			break ;
-
-		--nbVertices ;
-		Dart d1 = m_map.phi2(m_map.phi1(d)) ;
-		Dart d2 = m_map.phi2(m_map.phi_1(d)) ;
-	    Dart dd1 = m_map.phi2(m_map.phi1(m_map.phi2(d))) ;
-		Dart dd2 = m_map.phi2(m_map.phi_1(m_map.phi2(d))) ;
-
-		VSplit<PFP>* vs = new VSplit<PFP>(m_map, d, dd2, d2, dd1, d1) ;	// create new VSplit node 
-        
-        Node* n = new Node(vs);   //Création du nouveau noeud de l'arbre
-
-        Node* n_d2 = noeud[d2].node;
-        Node* n_dd2 = noeud[dd2].node;
-
-        /*Mise en place de la hiérarchie par rapport au nouveau noeud*/
-        n->setLeftChild(n_d2);
-        n->setRightChild(n_dd2);
-        n_d2->setParent(n);
-        n_dd2->setParent(n);
-
-        /*Calcul de la hauteur du plus grand arbre de la forêt*/
-        int height;
-        if(noeud[d2].node->getHeight()>noeud[dd2].node->getHeight()) {
-            height = noeud[d2].node->getHeight();
-        }
-        else {
-            height = noeud[dd2].node->getHeight();
-        }
-
-        /*Suppression des deux anciens noeuds du front courant*/
-        m_active_nodes.erase(n_d2->getCurrentPosition());
-        m_active_nodes.erase(n_dd2->getCurrentPosition());
-        n_d2->setActive(false);
-        n_dd2->setActive(false);
-        
-        /*Ajout du nouveau noeud au front courant*/
-        n->setActive(true);
-        m_active_nodes.push_back(n);
-        n->setCurrentPosition(--m_active_nodes.end());
-        
-        n->setHeight(height+1);
-        
-        if(m_height<=height) {
-            //Si la hauteur du plus grand arbre est inférieure ou égale à celle de l'arbre actuel
-            //NB: La hauteur du plus grand arbre ne sera jamais inférieure à celle de l'arbre courant
-            ++m_height;
-        }
-
-		for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
-		{
-			(*it)->approximate(d) ;					// compute approximated attributes with its associated detail
-			(*it)->saveApprox(d) ;
-		}
+    if(m_buildMode == BUILD_PARALLEL) {
+        createPMParallel(nbVertices, nbWantedVertices);
+    }
+    else if(m_ordering == ORDER_LAZY_QUEUE) {
+        createPMQueue(nbVertices, nbWantedVertices);
+    }
+    else {
+        if(m_balanceWeight > REAL(0))
+            CGoGNerr << "balance weight ignored by the CGoGN selector ordering" << CGoGNendl ;
 
-		m_selector->updateBeforeCollapse(d) ;		// update selector
+        VDPM_TIMER(PHASE_COLLAPSES);
+        bool finished = false ;
+        Dart d ;
+        while(!finished)
+        {
+            if(!m_selector->nextEdge(d))
+                break ;
 
-		edgeCollapse(n->getVSplit()) ;							// collapse edge
+            --nbVertices ;
 
-		unsigned int newV = m_map.template setOrbitEmbeddingOnNewCell<VERTEX>(d2) ;
-		unsigned int newE1 = m_map.template setOrbitEmbeddingOnNewCell<EDGE>(d2) ;
-		unsigned int newE2 = m_map.template setOrbitEmbeddingOnNewCell<EDGE>(dd2) ;
-		n->getVSplit()->setApproxV(newV) ;
-		n->getVSplit()->setApproxE1(newE1) ;
-		n->getVSplit()->setApproxE2(newE2) ;
-        
-        noeud[d2].node = n; //Affectation du nouveau noeud a l'attribut de sommet
-        n->setVertex(m_map.template getEmbedding<VERTEX>(d2));  //Indique le numéro de sommet pointant sur ce noeud
-        
-		for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
-			(*it)->affectApprox(d2);				// affect data to the resulting vertex
+            for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
+                (*it)->approximate(d) ;					// compute approximated attributes with its associated detail
 
-		m_selector->updateAfterCollapse(d2, dd2) ;	// update selector
+            collapseAndLink(d, true) ;
+            VDPM_COUNT(PROF_COLLAPSE_ATTEMPTED);
+            VDPM_COUNT(PROF_COLLAPSE_APPLIED);
 
-		if(nbVertices <= nbWantedVertices)
-			finished = true ;
-	}
+            if(nbVertices <= nbWantedVertices)
+                finished = true ;
+        }
+    }
 	delete m_selector ;
 	m_selector = NULL ;
 
+	computeBounds() ;
+
 	CGoGNout << "..done (" << nbVertices << " vertices)" << CGoGNendl ;
     CGoGNout << m_active_nodes.size() << " active nodes" << CGoGNendl;
     CGoGNout << "Hauteur du plus grand arbre de la forêt : " << m_height << CGoGNendl;
+    printHeightDistribution();
+    printMemoryUsage();
+}
+
+template <typename PFP>
+unsigned int VDProgressiveMesh<PFP>::collapseAndLink(Dart d, bool updateSelector)
+{
+    Dart d2 = m_map.phi2(m_map.phi_1(d)) ;
+    Dart dd2 = m_map.phi2(m_map.phi_1(m_map.phi2(d))) ;
+
+    m_splits.push_back(VSplit(d, dd2, d2)) ;	// create new VSplit record
+    VSplit& vs = m_splits.back() ;
+
+    unsigned int n = m_nodes.addNode(m_splits.size() - 1);   //Création du nouveau noeud de l'arbre
+
+    unsigned int n_d2 = noeud[d2].node;
+    unsigned int n_dd2 = noeud[dd2].node;
+
+    /*Mise en place de la hiérarchie par rapport au nouveau noeud*/
+    m_nodes.setLeftChild(n, n_d2);
+    m_nodes.setRightChild(n, n_dd2);
+    m_nodes.setParent(n_d2, n);
+    m_nodes.setParent(n_dd2, n);
+
+    /*Calcul de la hauteur du plus grand arbre de la forêt*/
+    int height;
+    if(m_nodes.getHeight(n_d2)>m_nodes.getHeight(n_dd2)) {
+        height = m_nodes.getHeight(n_d2);
+    }
+    else {
+        height = m_nodes.getHeight(n_dd2);
+    }
+
+    /*Suppression des deux anciens noeuds du front courant*/
+    m_active_nodes.remove(n_d2);
+    m_active_nodes.remove(n_dd2);
+    m_nodes.setActive(n_d2, false);
+    m_nodes.setActive(n_dd2, false);
+    
+    /*Ajout du nouveau noeud au front courant*/
+    m_nodes.setActive(n, true);
+    m_active_nodes.insert(n);
+    
+    m_nodes.setHeight(n, height+1);
+    
+    if(m_height<=height) {
+        //Si la hauteur du plus grand arbre est inférieure ou égale à celle de l'arbre actuel
+        //NB: La hauteur du plus grand arbre ne sera jamais inférieure à celle de l'arbre courant
+        ++m_height;
+    }
+
+    for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
+        (*it)->saveApprox(d) ;
+
+    if(updateSelector)
+        m_selector->updateBeforeCollapse(d) ;		// update selector
+
+    edgeCollapse(vs) ;							// collapse edge
+
+    unsigned int newV = m_map.template setOrbitEmbeddingOnNewCell<VERTEX>(d2) ;
+    unsigned int newE1 = m_map.template setOrbitEmbeddingOnNewCell<EDGE>(d2) ;
+    unsigned int newE2 = m_map.template setOrbitEmbeddingOnNewCell<EDGE>(dd2) ;
+    vs.setApprox(newV, newE1, newE2) ;
+    //Les lignes restent référencées par le VSplit tant que la hiérarchie existe
+    m_map.template getAttributeContainer<VERTEX>().refLine(newV) ;
+    AttributeContainer& edgeCont = m_map.template getAttributeContainer<EDGE>() ;
+    edgeCont.refLine(newE1) ;
+    edgeCont.refLine(newE2) ;
+    
+    noeud[d2].node = n; //Affectation du nouveau noeud a l'attribut de sommet
+    m_nodes.setVertex(n, m_map.template getEmbedding<VERTEX>(d2));  //Indique le numéro de sommet pointant sur ce noeud
+    
+    for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
+        (*it)->affectApprox(d2);				// affect data to the resulting vertex
+
+    //Cône des normales : ceux des fils et celui des faces autour du sommet contracté
+    m_cones.resize(m_nodes.size());
+    m_cones[n] = NormalCone::merge(NormalCone::merge(m_cones[n_d2], m_cones[n_dd2]), vertexNormalCone(d2));
+    //Normale du nouveau sommet sur le maillage contracté
+    m_nodeNormals.resize(m_nodes.size());
+    m_nodeNormals[n] = Algo::Surface::Geometry::vertexNormal<PFP>(m_map, d2, positionsTable);
+
+    if(updateSelector)
+        m_selector->updateAfterCollapse(d2, dd2) ;	// update selector
+
+    return n;
+}
+
+/*
+ * Ramène la carte à sa résolution d'origine. Les noeuds internes étant rangés dans
+ * l'ordre de construction, les VSplit appliqués dans l'ordre inverse des indices
+ * rencontrent toujours leur voisinage d'origine : un seul passage suffit.
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::restoreFullResolution()
+{
+    for(unsigned int n = m_nodes.size(); n-- > 0; ) {
+        if(m_nodes.isActive(n) && m_nodes.getVSplit(n) != NO_SPLIT)
+            refine(n);
+    }
+    for(std::vector<VSplit>::iterator it = m_splits.begin(); it != m_splits.end(); ++it) {
+        if(inactiveMarker.isMarked(it->getEdge()))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Libère la hiérarchie en bloc (lignes d'approximation comprises). Les tableaux
+ * gardent leur capacité pour être réutilisés par la construction suivante.
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::clearHierarchy()
+{
+    releaseSplits();
+    m_nodes.clear();
+    m_active_nodes.clear();
+    m_spheres.clear();
+    m_cones.clear();
+    m_errors.clear();
+    m_nodeNormals.clear();
+    m_rootHierarchy.clear();
+    resetRefinementState();
+    m_height = 0;
+    if(m_trackChanges)
+        m_changes.requestRebuild();
+}
+
+/*
+ * Libère en bloc les lignes d'approximation référencées par les VSplit
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::releaseSplits()
+{
+    AttributeContainer& vertexCont = m_map.template getAttributeContainer<VERTEX>() ;
+    AttributeContainer& edgeCont = m_map.template getAttributeContainer<EDGE>() ;
+    for(std::vector<VSplit>::iterator it = m_splits.begin(); it != m_splits.end(); ++it) {
+        if(it->getApproxV() != EMBNULL) vertexCont.unrefLine(it->getApproxV()) ;
+        if(it->getApproxE1() != EMBNULL) edgeCont.unrefLine(it->getApproxE1()) ;
+        if(it->getApproxE2() != EMBNULL) edgeCont.unrefLine(it->getApproxE2()) ;
+    }
+    m_splits.clear() ;
+}
+
+/*
+ * Arêtes opposées d'un VSplit, déduites de la topologie courante : cousues à
+ * l'arête gauche (resp. droite) lorsque la paire de triangles est extraite, au côté
+ * phi1 de l'arête contractée (resp. de son phi2) lorsqu'elle est insérée
+ */
+template <typename PFP>
+Dart VDProgressiveMesh<PFP>::getOppositeLeftEdge(const VSplit& vs)
+{
+    Dart d = vs.getEdge() ;
+    if(inactiveMarker.isMarked(d))
+        return m_map.phi2(vs.getLeftEdge()) ;
+    return m_map.phi2(m_map.phi1(d)) ;
+}
+
+template <typename PFP>
+Dart VDProgressiveMesh<PFP>::getOppositeRightEdge(const VSplit& vs)
+{
+    Dart dd = m_map.phi2(vs.getEdge()) ;
+    if(inactiveMarker.isMarked(dd))
+        return m_map.phi2(vs.getRightEdge()) ;
+    return m_map.phi2(m_map.phi1(dd)) ;
+}
+
+/*
+ * Cône des normales des faces actives autour du sommet de d
+ */
+template <typename PFP>
+NormalCone VDProgressiveMesh<PFP>::vertexNormalCone(Dart d)
+{
+    NormalCone cone;
+    Dart it = d;
+    do {
+        if(!inactiveMarker.isMarked(it)) {
+            const VEC3& p0 = positionsTable[it];
+            VEC3 nrm = (positionsTable[m_map.phi1(it)] - p0) ^ (positionsTable[m_map.phi_1(it)] - p0);
+            if(nrm.norm2() > 0.0f) {
+                nrm.normalize();
+                cone = NormalCone::merge(cone, NormalCone(nrm, 0.0f));
+            }
+        }
+        it = m_map.phi2(m_map.phi_1(it));
+    } while(it != d);
+    return cone;
 }
 
+/*
+ * Construction par tours : à chaque tour, toutes les arêtes sont évaluées en parallèle,
+ * puis un ensemble maximal de contractions dont les voisinages (1-anneaux fermés des
+ * deux extrémités) sont disjoints est retenu dans l'ordre (coût, clé de départage).
+ * Deux contractions ainsi retenues ne partagent aucune face et ne peuvent pas invalider
+ * la condition de lien de l'autre : les approximations sont donc calculées en parallèle.
+ * Les modifications de la carte (qui n'est pas réentrante) et le chaînage des noeuds
+ * restent séquentiels, dans l'ordre de sélection : à graine égale le résultat est
+ * identique quel que soit le nombre de threads.
+ */
 template <typename PFP>
-void VDProgressiveMesh<PFP>::edgeCollapse(VSplit<PFP>* vs)
+void VDProgressiveMesh<PFP>::createPMParallel(unsigned int& nbVertices, unsigned int nbWantedVertices)
 {
-	Dart d = vs->getEdge() ;
+    VDPM_TIMER(PHASE_COLLAPSES);
+    std::vector<CollapseCandidate> candidates;
+    std::vector<Dart> selected;
+    unsigned int round = 0;
+
+    while(nbVertices > nbWantedVertices) {
+        /*Recensement des arêtes actives*/
+        candidates.clear();
+        TraversorE<MAP> trav(m_map, dartSelect);
+        for(Dart d = trav.begin(); d != trav.end(); d = trav.next()) {
+            CollapseCandidate c;
+            c.d = d;
+            candidates.push_back(c);
+        }
+
+        /*Evaluation des coûts et de la légalité (lecture seule sur la carte)*/
+        int nbCandidates = int(candidates.size());
+        #pragma omp parallel for schedule(static)
+        for(int i = 0; i < nbCandidates; ++i) {
+            CollapseCandidate& c = candidates[i];
+            c.legal = isCollapsible(c.d);
+            c.cost = c.legal ? collapseCost(c.d) : REAL(0);
+            c.key = tieBreakKey(c.d);
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+        VDPM_COUNT_ADD(PROF_COLLAPSE_ATTEMPTED, candidates.size());
+
+        /*Sélection gloutonne d'un ensemble indépendant maximal*/
+        selected.clear();
+        unsigned int maxSelected = nbVertices - nbWantedVertices;
+        {
+            CellMarkerStore<VERTEX> conflicts(m_map);
+            for(typename std::vector<CollapseCandidate>::iterator it = candidates.begin(); it != candidates.end() && selected.size() < maxSelected; ++it) {
+                if(!it->legal) {
+                    VDPM_COUNT(PROF_COLLAPSE_REJECTED);
+                    continue;
+                }
+                if(isNeighbourhoodMarked(it->d, conflicts))
+                    continue;
+                markNeighbourhood(it->d, conflicts);
+                selected.push_back(it->d);
+            }
+        }
+
+        if(selected.empty())
+            break;
+
+        /*Calcul des approximations : les arêtes retenues ont des voisinages disjoints*/
+        int nbSelected = int(selected.size());
+        #pragma omp parallel for schedule(static)
+        for(int i = 0; i < nbSelected; ++i) {
+            for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
+                (*it)->approximate(selected[i]) ;
+        }
+
+        /*Application des contractions et chaînage des noeuds du tour*/
+        for(std::vector<Dart>::iterator it = selected.begin(); it != selected.end(); ++it) {
+            collapseAndLink(*it, false);
+            --nbVertices;
+            VDPM_COUNT(PROF_COLLAPSE_APPLIED);
+        }
+        ++round;
+    }
+
+    CGoGNout << ".." << round << " rounds" << CGoGNflush;
+}
+
+/*
+ * Construction séquentielle ordonnée par la file à invalidation paresseuse.
+ * Après une contraction, seules les arêtes incidentes au nouveau sommet reçoivent un
+ * nouveau tampon et une nouvelle entrée : les entrées précédentes deviennent périmées
+ * et sont ignorées lorsqu'elles sortent du tas. Les coûts de ces arêtes sont
+ * recalculés dès la contraction plutôt qu'au dépilement de leur ancienne entrée : celle-ci
+ * sortirait au coût d'avant la contraction, si bien qu'une arête raccourcie serait
+ * contractée trop tard et l'ordre (donc la forêt) différerait de celui du sélecteur ;
+ * le recalcul ne porte que sur le 1-anneau (une longueur d'arête chacun).
+ * La légalité (condition de lien) n'est vérifiée qu'au moment du dépilement. Lorsque
+ * la file est épuisée, elle est reconstruite une fois à partir des arêtes actives pour
+ * récupérer les arêtes redevenues légales.
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::createPMQueue(unsigned int& nbVertices, unsigned int nbWantedVertices)
+{
+    VDPM_TIMER(PHASE_COLLAPSES);
+    unsigned int maxIndex = 0;
+    for(Dart d = m_map.begin(); d != m_map.end(); m_map.next(d)) {
+        if(d.index > maxIndex)
+            maxIndex = d.index;
+    }
+    m_dartStamp.assign(maxIndex + 1, 0);
+    m_stamp = 0;
+    m_queue.clear();
+    m_queue.reserve(m_map.template getNbOrbits<EDGE>() * 2);
+
+    bool collapsedSinceFill = true;
+    while(nbVertices > nbWantedVertices) {
+        if(m_queue.empty()) {
+            if(!collapsedSinceFill)
+                break;  //Aucune contraction légale depuis la dernière reconstruction
+            fillQueue();
+            collapsedSinceFill = false;
+            if(m_queue.empty())
+                break;
+        }
+
+        typename CollapseQueue<REAL>::Entry e = m_queue.top();
+        m_queue.pop();
+        Dart d = e.dart;
+        VDPM_COUNT(PROF_COLLAPSE_ATTEMPTED);
+
+        /*Entrée périmée : arête supprimée ou réévaluée depuis son insertion*/
+        if(inactiveMarker.isMarked(d) || m_dartStamp[d.index] != e.stamp) {
+            VDPM_COUNT(PROF_COLLAPSE_REJECTED);
+            continue;
+        }
+
+        if(!isCollapsible(d)) {
+            VDPM_COUNT(PROF_COLLAPSE_REJECTED);
+            continue;
+        }
+
+        --nbVertices;
+
+        for(typename std::vector<Algo::Surface::Decimation::ApproximatorGen<PFP>*>::iterator it = m_approximators.begin(); it != m_approximators.end(); ++it)
+            (*it)->approximate(d) ;
+
+        unsigned int n = collapseAndLink(d, false);
+        VDPM_COUNT(PROF_COLLAPSE_APPLIED);
+        pushVertexEdges(m_splits[m_nodes.getVSplit(n)].getLeftEdge());
+        collapsedSinceFill = true;
+    }
+
+    m_queue.clear();
+    std::vector<unsigned int>().swap(m_dartStamp);
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::fillQueue()
+{
+    TraversorE<MAP> trav(m_map, dartSelect);
+    for(Dart d = trav.begin(); d != trav.end(); d = trav.next())
+        pushEdge(d);
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::pushEdge(Dart d)
+{
+    //Le tampon est porté par les deux brins de l'arête
+    unsigned int stamp = ++m_stamp;
+    m_dartStamp[d.index] = stamp;
+    m_dartStamp[m_map.phi2(d).index] = stamp;
+    m_queue.push(collapseCost(d), d, stamp);
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::pushVertexEdges(Dart d)
+{
+    Dart it = d;
+    do {
+        pushEdge(it);
+        it = m_map.phi2(m_map.phi_1(it));
+    } while(it != d);
+}
+
+template <typename PFP>
+typename PFP::REAL VDProgressiveMesh<PFP>::collapseCost(Dart d)
+{
+    //Même critère que EdgeSelector_Length : carré de la longueur de l'arête
+    VEC3 vec = positionsTable[m_map.phi1(d)] - positionsTable[d];
+    REAL cost = vec.norm2();
+
+    if(m_balanceWeight > REAL(0)) {
+        /*Pénalité relative à la hauteur du plus grand des deux futurs fils*/
+        int h1 = m_nodes.getHeight(noeud[d].node);
+        int h2 = m_nodes.getHeight(noeud[m_map.phi1(d)].node);
+        cost *= REAL(1) + m_balanceWeight * REAL(h1 > h2 ? h1 : h2);
+    }
+    return cost;
+}
+
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::isCollapsible(Dart d)
+{
+    if(m_locked && (m_locked->isMarked(d) || m_locked->isMarked(m_map.phi1(d))))
+        return false;
+    return m_map.edgeCanCollapse(d);
+}
+
+template <typename PFP>
+unsigned int VDProgressiveMesh<PFP>::tieBreakKey(Dart d)
+{
+    //Mélange entier (murmur3 finalizer) de l'indice du brin et de la graine
+    unsigned int h = d.index ^ (m_seed * 0x9e3779b9u);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::isNeighbourhoodMarked(Dart d, CellMarkerStore<VERTEX>& cm)
+{
+    Dart ends[2] = { d, m_map.phi2(d) };
+    for(unsigned int i = 0; i < 2; ++i) {
+        Dart it = ends[i];
+        do {
+            if(cm.isMarked(it) || cm.isMarked(m_map.phi1(it)))
+                return true;
+            it = m_map.phi2(m_map.phi_1(it));
+        } while(it != ends[i]);
+    }
+    return false;
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::markNeighbourhood(Dart d, CellMarkerStore<VERTEX>& cm)
+{
+    Dart ends[2] = { d, m_map.phi2(d) };
+    for(unsigned int i = 0; i < 2; ++i) {
+        cm.mark(ends[i]);
+        Dart it = ends[i];
+        do {
+            if(!cm.isMarked(m_map.phi1(it)))
+                cm.mark(m_map.phi1(it));
+            it = m_map.phi2(m_map.phi_1(it));
+        } while(it != ends[i]);
+    }
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::edgeCollapse(const VSplit& vs)
+{
+	Dart d = vs.getEdge() ;
 	Dart dd = m_map.phi2(d) ;
 
 	inactiveMarker.markOrbit<FACE>(d) ;
@@ -219,12 +650,12 @@ void VDProgressiveMesh<PFP>::edgeCollapse(VSplit<PFP>* vs)
 }
 
 template <typename PFP>
-void VDProgressiveMesh<PFP>::vertexSplit(VSplit<PFP>* vs)
+void VDProgressiveMesh<PFP>::vertexSplit(const VSplit& vs)
 {
-	Dart d = vs->getEdge() ;
+	Dart d = vs.getEdge() ;
 	Dart dd = m_map.phi2(d) ;
-	Dart d2 = vs->getLeftEdge() ;
-	Dart dd2 = vs->getRightEdge() ;
+	Dart d2 = vs.getLeftEdge() ;
+	Dart dd2 = vs.getRightEdge() ;
             
 	m_map.insertTrianglePair(d, d2, dd2) ;
 
@@ -235,47 +666,59 @@ void VDProgressiveMesh<PFP>::vertexSplit(VSplit<PFP>* vs)
 template <typename PFP>
 void VDProgressiveMesh<PFP>::coarsen() {
     CGoGNout << "COARSEN" << CGoGNendl;
-    std::list<Node*>::iterator it = m_active_nodes.begin();
-	while(it != m_active_nodes.end()) {
-		it = coarsen(*it);
+    //Un seul niveau par appel : les parents ajoutés pendant le parcours ne sont pas visités
+    m_active_nodes.beginScan();
+    unsigned int end = m_active_nodes.slotCount();
+	for(unsigned int i = 0; i < end; ++i) {
+		coarsen(m_active_nodes.at(i));
 	}
+    m_active_nodes.endScan();
     drawFront();
 }
 
 template <typename PFP>
-std::list<Node*>::iterator VDProgressiveMesh<PFP>::coarsen(Node* n)
+bool VDProgressiveMesh<PFP>::coarsen(unsigned int n)
 {
-	std::list<Node*>::iterator res = m_active_nodes.end();
-    if(n && n->isActive()) {
+	bool res = false;
+    if(n != NO_NODE && m_nodes.isActive(n)) {
         //Si n fait partie du front et qu'il n'est pas contenu dans la boîte d'intérêt
-        Node* parent = n->getParent();
-        if(parent && !parent->isActive()) {
+        unsigned int parent = m_nodes.getParent(n);
+        if(parent != NO_NODE && !m_nodes.isActive(parent)) {
             /*Si le noeud parent existe et qu'il ne fait pas partie du front*/
-            Node* child_left = parent->getLeftChild();
-            Node* child_right = parent->getRightChild();
-            if(child_left && child_left->isActive()
-            && child_right && child_right->isActive()) {
+            unsigned int child_left = m_nodes.getLeftChild(parent);
+            unsigned int child_right = m_nodes.getRightChild(parent);
+            if(child_left != NO_NODE && m_nodes.isActive(child_left)
+            && child_right != NO_NODE && m_nodes.isActive(child_right)) {
                 //Si n a un noeud parent et que celui-ci ne fait pas partie du front
-                VSplit<PFP>* vs = parent->getVSplit(); 
-                Dart d2 = vs->getLeftEdge();
-                Dart dd2 = vs->getRightEdge();
-                Dart d1 = vs->getOppositeLeftEdge();
-                Dart dd1 = vs->getOppositeRightEdge();
+                VDPM_COUNT(PROF_COARSEN_ATTEMPTED);
+                const VSplit& vs = m_splits[m_nodes.getVSplit(parent)]; 
+                Dart d2 = vs.getLeftEdge();
+                Dart dd2 = vs.getRightEdge();
+                Dart d1 = getOppositeLeftEdge(vs);
+                Dart dd1 = getOppositeRightEdge(vs);
 
                 if( inactiveMarker.isMarked(d1)
                 ||  inactiveMarker.isMarked(d2)
                 ||  inactiveMarker.isMarked(dd1)
-                ||  inactiveMarker.isMarked(dd2))
+                ||  inactiveMarker.isMarked(dd2)) {
+                    VDPM_COUNT(PROF_COARSEN_REJECTED);
                     return res;
+                }
 
                 //CGoGNout << "Ancien D2 : " << m_map.template getEmbedding<VERTEX>(d2) << CGoGNendl;
                 //CGoGNout << "Ancien DD2 : " << m_map.template getEmbedding<VERTEX>(dd2) << CGoGNendl;
 
+                if(m_trackChanges) {
+                    //Faces autour des deux extrémités, y compris les deux qui disparaissent
+                    recordStar(vs.getEdge());
+                    recordStar(m_map.phi2(vs.getEdge()));
+                }
+
                 edgeCollapse(vs);
 
-                m_map.template setOrbitEmbedding<VERTEX>(d2, vs->getApproxV());
-	            m_map.template setOrbitEmbedding<EDGE>(d2, vs->getApproxE1());
-                m_map.template setOrbitEmbedding<EDGE>(dd2, vs->getApproxE2());
+                m_map.template setOrbitEmbedding<VERTEX>(d2, vs.getApproxV());
+	            m_map.template setOrbitEmbedding<EDGE>(d2, vs.getApproxE1());
+                m_map.template setOrbitEmbedding<EDGE>(dd2, vs.getApproxE2());
 
                 if(m_map.template getEmbedding<VERTEX>(d2) != m_map.template getEmbedding<VERTEX>(dd2)) {
 					//CGoGNout << "Nouveau D2 : " << m_map.template getEmbedding<VERTEX>(d2) << CGoGNendl;
@@ -283,13 +726,20 @@ std::list<Node*>::iterator VDProgressiveMesh<PFP>::coarsen(Node* n)
                 }
 
                 //Mise a jour des informations de l'arbre
-                m_active_nodes.erase(child_left->getCurrentPosition());
-                res = m_active_nodes.erase(child_right->getCurrentPosition());
-                child_left->setActive(false);
-                child_right->setActive(false);
-                parent->setActive(true);
-                m_active_nodes.push_back(parent);
-                parent->setCurrentPosition(--m_active_nodes.end());
+                m_active_nodes.remove(child_left);
+                m_active_nodes.remove(child_right);
+                m_active_nodes.insert(parent);
+                VDPM_SET(PROF_FRONT_SIZE, m_active_nodes.size());
+                if(m_trackChanges) {
+                    m_changes.nodes.push_back(child_left);
+                    m_changes.nodes.push_back(child_right);
+                    m_changes.nodes.push_back(parent);
+                }
+                m_nodes.setActive(child_left, false);
+                m_nodes.setActive(child_right, false);
+                m_nodes.setActive(parent, true);
+                VDPM_COUNT(PROF_COARSEN_APPLIED);
+                res = true;
             }
         }
     }
@@ -299,36 +749,36 @@ std::list<Node*>::iterator VDProgressiveMesh<PFP>::coarsen(Node* n)
 template <typename PFP>
 void VDProgressiveMesh<PFP>::refine() {
     CGoGNout << "REFINE" << CGoGNendl;
-    std::list<Node*>::iterator it = m_active_nodes.begin();
-	while(it!=m_active_nodes.end()) {
-		it=refine(*it);
+    //Un seul niveau par appel : les fils ajoutés pendant le parcours ne sont pas visités
+    m_active_nodes.beginScan();
+    unsigned int end = m_active_nodes.slotCount();
+	for(unsigned int i = 0; i < end; ++i) {
+		refine(m_active_nodes.at(i));
 	}
+    m_active_nodes.endScan();
     drawFront();
 }
 
 template <typename PFP>
-std::list<Node*>::iterator VDProgressiveMesh<PFP>::refine(Node* n)
+bool VDProgressiveMesh<PFP>::refine(unsigned int n)
 {
-    std::list<Node*>::iterator res = m_active_nodes.end();
-    if(n && n->isActive()) {
+    bool res = false;
+    if(n != NO_NODE && m_nodes.isActive(n)) {
         //Si n fait partie du front
-        Node* child_left = n->getLeftChild();
-        Node* child_right = n->getRightChild();
-        if( child_left && !child_left->isActive() 
-        &&  child_right && !child_right->isActive()) {
+        unsigned int child_left = m_nodes.getLeftChild(n);
+        unsigned int child_right = m_nodes.getRightChild(n);
+        if( child_left != NO_NODE && !m_nodes.isActive(child_left) 
+        &&  child_right != NO_NODE && !m_nodes.isActive(child_right)) {
             //Si n a deux fils et que ceux-ci ne font pas partie du front
-            VSplit<PFP>* vs = n->getVSplit();
+            VDPM_COUNT(PROF_REFINE_ATTEMPTED);
+            const VSplit& vs = m_splits[m_nodes.getVSplit(n)];
 
-	        Dart d = vs->getEdge();
+	        Dart d = vs.getEdge();
 	        Dart dd = m_map.phi2(d);
-	        Dart d2 = vs->getLeftEdge();
-	        Dart dd2 = vs->getRightEdge();
-	        //Dart d1 = vs->getOppositeLeftEdge();
+	        Dart d2 = vs.getLeftEdge();
+	        Dart dd2 = vs.getRightEdge();
 	        Dart d1 = m_map.phi2(d2) ;	//On prend les côtés opposés
-	        //vs->setOppositeLeftEdge(d1);
-			//Dart dd1 = vs->getOppositeRightEdge();
 	        Dart dd1 = m_map.phi2(dd2) ;
-			//vs->setOppositeRightEdge(dd1);
 
 	        //Vérification de la présence des brins entourant la paire de triangles
             if( inactiveMarker.isMarked(d1)
@@ -336,12 +786,14 @@ std::list<Node*>::iterator VDProgressiveMesh<PFP>::refine(Node* n)
             ||  inactiveMarker.isMarked(dd1)
             ||  inactiveMarker.isMarked(dd2)) {
 				//CGoGNout << "Un des brins (au moins) entourant la paire de triangles n'est pas présent" << CGoGNendl;
+                VDPM_COUNT(PROF_REFINE_REJECTED);
                 return res;
             }
 
             //Vérification de la bonne configuration des faces adjacentes
             if(m_map.template getEmbedding<VERTEX>(d2) != m_map.template getEmbedding<VERTEX>(dd2)) {
             	//CGoGNout << "D2 et DD2 ne sont pas orientés sur le même sommet" << CGoGNendl;
+            	VDPM_COUNT(PROF_REFINE_REJECTED);
             	return res;
             }
 
@@ -364,243 +816,1083 @@ std::list<Node*>::iterator VDProgressiveMesh<PFP>::refine(Node* n)
             m_map.template copyDartEmbedding<VERTEX>(m_map.phi_1(d), d1);
             m_map.template copyDartEmbedding<VERTEX>(m_map.phi_1(dd), dd1);
 
+            if(m_trackChanges) {
+                //Faces autour des deux nouveaux sommets, y compris les deux réinsérées
+                recordStar(d);
+                recordStar(dd);
+            }
+
             //Mise a jour des informations de l'arbre
-            res = m_active_nodes.erase(n->getCurrentPosition());
-            n->setActive(false);
-            child_left->setActive(true);
-            child_right->setActive(true);
-            m_active_nodes.push_front(child_left);
-            child_left->setCurrentPosition(m_active_nodes.begin());
-            m_active_nodes.push_front(child_right);
-            child_right->setCurrentPosition(m_active_nodes.begin());
-            res++;
+            m_active_nodes.remove(n);
+            m_active_nodes.insert(child_left);
+            m_active_nodes.insert(child_right);
+            VDPM_SET(PROF_FRONT_SIZE, m_active_nodes.size());
+            if(m_trackChanges) {
+                m_changes.nodes.push_back(n);
+                m_changes.nodes.push_back(child_left);
+                m_changes.nodes.push_back(child_right);
+            }
+            m_nodes.setActive(n, false);
+            m_nodes.setActive(child_left, true);
+            m_nodes.setActive(child_right, true);
+            VDPM_COUNT(PROF_REFINE_APPLIED);
+            res = true;
         }
     }
     return res;
 }
 
+template <typename PFP>
+void VDProgressiveMesh<PFP>::setChangeTracking(bool b) {
+	m_trackChanges = b;
+	m_changes.clear();
+	if(b)
+		m_changes.requestRebuild();
+}
+
+/*
+ * Note un brin de chaque face autour du sommet de d
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::recordStar(Dart d) {
+	Dart it = d;
+	do {
+		m_changes.darts.push_back(it);
+		it = m_map.phi2(m_map.phi_1(it));
+	} while(it != d);
+}
+
+/*
+ * Met le front à jour vis-à-vis de la boîte d'intérêt, sans limite de temps
+ */
 template <typename PFP>
 void VDProgressiveMesh<PFP>::updateRefinement() {
-	std::list<Node*>::iterator it = m_active_nodes.begin();
-	std::list<Node*>::iterator it_back;
-	bool non_transformation = false;
-	while(it != m_active_nodes.end()) {
-		if((*it) && (*it)->isActive()) {
-			non_transformation = false;
-			it_back = it;
-			++it_back;
-			if(m_bb->contains(positionsTable[(*it)->getVertex()])) {
-				//Si le noeud appartient à la boîte d'intérêt
-				it = refine(*it);
-				if(it_back==m_active_nodes.end()) {
-					it = m_active_nodes.end();
-				}
-				else {
-					if(it==m_active_nodes.end()) {
-						non_transformation = true;
-					}
-				}
+	updateRefinement(RefinementBudget());
+}
+
+/*
+ * Mise à jour par tranches : au plus budget.maxOperations transformations et/ou
+ * budget.maxSeconds secondes par appel. Le travail restant (curseur du parcours
+ * complet, pile de la descente) est conservé et repris à l'appel suivant ; si la
+ * boîte a bougé entre-temps, la différence symétrique avec la boîte visée jusque-là
+ * est ajoutée au travail en attente. Renvoie vrai lorsque le front a convergé.
+ *
+ * Tant que les sphères englobantes n'ont pas servi, la première mise à jour parcourt
+ * tout le front ; les suivantes sont incrémentales par rapport à la boîte visée
+ * précédemment. Avec les critères de vue et gradué, tout changement du critère (point
+ * de vue, boîte ou régions) relance un parcours complet du front, repris depuis le
+ * début s'il était en cours.
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::updateRefinement(const RefinementBudget& budget) {
+	VDPM_TIMER(PHASE_UPDATE_REFINEMENT);
+	bool boundsOk = m_nodes.size() > 0 && m_spheres.size() == m_nodes.size();
+	if(m_criterion != CRITERION_BOX) {
+		if(m_criterion == CRITERION_GRADED) {
+			if(!m_lastBoxValid || m_lastBoxMin != m_bb->getPosMin() || m_lastBoxMax != m_bb->getPosMax())
+				m_criterionChanged = true;
+			m_lastBoxMin = m_bb->getPosMin();
+			m_lastBoxMax = m_bb->getPosMax();
+			m_lastBoxValid = true;
+		}
+		if(boundsOk && m_criterionChanged) {
+			//Un parcours interrompu est clos avant d'être repris depuis le début : les
+			//cases vidées pendant celui-ci sont compactées, sans quoi un critère changeant
+			//à chaque tranche (caméra en mouvement) ferait croître le tableau sans fin
+			if(m_scanPending)
+				m_active_nodes.endScan();
+			m_active_nodes.beginScan();
+			m_scanPending = true;
+			m_scanCursor = 0;
+		}
+		m_criterionChanged = !boundsOk && m_criterionChanged;
+		RefinementSlice slice(budget);
+		return runSlice(slice);
+	}
+	if(!m_lastBoxValid || !boundsOk) {
+		if(!m_scanPending) {
+			m_active_nodes.beginScan();
+			m_scanCursor = 0;
+			m_scanPending = true;
+		}
+	}
+	else {
+		UpdateRegion region;
+		region.addSymmetricDifference(m_bb->getPosMin(), m_bb->getPosMax(), m_lastBoxMin, m_lastBoxMax);
+		pushRegion(region);
+	}
+	m_lastBoxMin = m_bb->getPosMin();
+	m_lastBoxMax = m_bb->getPosMax();
+	m_lastBoxValid = boundsOk;
+
+	RefinementSlice slice(budget);
+	return runSlice(slice);
+}
+
+/*
+ * Raffinement spéculatif, à appeler en temps libre (front convergé) avec son propre
+ * budget : si la boîte se déplace régulièrement, le volume qu'elle devrait balayer
+ * aux prochains déplacements devient une région d'intérêt, si bien qu'un balayage
+ * régulier trouve le maillage déjà raffiné. Une prédiction démentie (arrêt du
+ * mouvement régulier, changement de direction) n'est défaite qu'ici, en temps libre :
+ * les mises à jour prioritaires ne paient jamais la simplification de la zone
+ * anticipée. Sans effet avec le critère de vue, qui ignore les régions.
+ * La prédiction repose sur les relevés de recordInterestBox() : l'appelant relève la
+ * boîte à chaque déplacement, puis une dernière fois quand elle reste immobile, ce qui
+ * retire la zone anticipée au passage suivant.
+ * Renvoie vrai lorsque le front a convergé.
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::updatePrefetch(const RefinementBudget& budget) {
+	VDPM_TIMER(PHASE_PREFETCH);
+	if(m_prefetchRegion != NO_REGION && !m_regions.isValid(m_prefetchRegion))
+		m_prefetchRegion = NO_REGION;   //Régions vidées entre-temps
+	VEC3 pred_min, pred_max;
+	if(m_criterion != CRITERION_VIEW && m_predictor.predict(m_bb->getPosMin(), m_bb->getPosMax(), pred_min, pred_max)) {
+		if(m_prefetchRegion == NO_REGION)
+			m_prefetchRegion = addInterestBox(pred_min, pred_max);
+		else if(m_regions.get(m_prefetchRegion).pos_min != pred_min || m_regions.get(m_prefetchRegion).pos_max != pred_max)
+			moveInterestBox(m_prefetchRegion, pred_min, pred_max);
+	}
+	else if(m_prefetchRegion != NO_REGION) {
+		removeInterestRegion(m_prefetchRegion);
+		m_prefetchRegion = NO_REGION;
+	}
+	return updateRefinement(budget);
+}
+
+/*
+ * Une tranche de travail avec le test du critère courant, résolu à la compilation
+ * dans les parcours (un seul appel virtuel par tranche pour le critère gradué)
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::runSlice(RefinementSlice& slice) {
+	switch(m_criterion) {
+		case CRITERION_VIEW :
+			return runSlice(slice, ViewTest(*this));
+		case CRITERION_GRADED :
+			if(m_graded)
+				return m_graded->run(*this, slice);
+			return runSlice(slice, RegionTest(*this));
+		default :
+			return runSlice(slice, RegionTest(*this));
+	}
+}
+
+template <typename PFP>
+template <typename Criterion>
+bool VDProgressiveMesh<PFP>::runSlice(RefinementSlice& slice, const Criterion& wanted) {
+	if(m_scanPending && !processScan(slice, wanted))
+		return false;
+	//Les raffinements forcés rendent actifs des fils qui sont examinés à leur tour
+	do {
+		if(!processPending(slice, wanted) || !processBlocked(slice, wanted))
+			return false;
+	} while(!m_pending.empty());
+	return true;
+}
+
+/*
+ * Mise à jour parallèle complète du front (sans budget), par tours. A chaque tour,
+ * les transformations demandées par le critère sont recensées sur le front en
+ * parallèle (lecture seule : tests du critère, coûteux avec les critères de vue et
+ * gradué), puis appliquées séquentiellement dans l'ordre du front. Les
+ * transformations écrivent dans la carte et ses conteneurs partagés (lignes
+ * d'attributs référencées ou libérées, marqueur des brins inactifs), qui ne
+ * supportent pas d'écritures concurrentes. Lorsqu'un tour n'a plus rien appliqué,
+ * les raffinements refusés par la topologie sont forcés, et les tours reprennent
+ * tant que le front change.
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::updateRefinementParallel() {
+	VDPM_TIMER(PHASE_PARALLEL);
+	bool boundsOk = m_nodes.size() > 0 && m_spheres.size() == m_nodes.size();
+	if(!boundsOk)
+		return;
+
+	//Le parcours complet remplace le travail en attente d'une mise à jour par tranches
+	if(m_scanPending)
+		m_active_nodes.endScan();
+	m_scanPending = false;
+	m_scanCursor = 0;
+	m_pending.clear();
+	m_pendingRegion.clear();
+	m_blockedRefine.clear();
+	m_blockedCoarsen.clear();
+
+	switch(m_criterion) {
+		case CRITERION_VIEW :
+			refineRounds(ViewTest(*this));
+			break;
+		case CRITERION_GRADED :
+			if(m_graded) {
+				m_graded->runParallel(*this);
+				break;
 			}
-			else {
-				//Si le noeud n'appartient pas à la boîte d'intérêt
-				if((*it)->getParent()) {
-					Node* child_left = (*it)->getParent()->getLeftChild();	//Possibilité d'être le noeud courant
-					Node* child_right = (*it)->getParent()->getRightChild();	//Possibilité d'être le noeud courant
-					if(		!m_bb->contains(positionsTable[(*it)->getParent()->getVertex()])
-						&&	!m_bb->contains(positionsTable[child_left->getVertex()])
-						&& 	!m_bb->contains(positionsTable[child_right->getVertex()])) {
-						//Si le noeud a un parent qui n'appartient pas à la boîte d'intérêt
-						it = coarsen(*it);
-						if(it==m_active_nodes.end()) {
-							non_transformation = true;
-						}
-					}
-					else {
-						++it;
-					}
-				}
-				else {
-					++it;
-				}
+			refineRounds(RegionTest(*this));
+			break;
+		default :
+			refineRounds(RegionTest(*this));
+			break;
+	}
+
+	//Le front est à jour pour la boîte et le critère courants
+	m_lastBoxMin = m_bb->getPosMin();
+	m_lastBoxMax = m_bb->getPosMax();
+	m_lastBoxValid = true;
+	m_criterionChanged = false;
+}
+
+template <typename PFP>
+template <typename Criterion>
+void VDProgressiveMesh<PFP>::refineRounds(const Criterion& wanted) {
+	enum { NONE, REFINE, COARSEN };
+	std::vector<unsigned int> nodes;
+	std::vector<unsigned char> action;
+	std::vector<bool> forced(m_nodes.size(), false);  //Un forçage par noeud : les tours s'arrêtent
+	unsigned int applied = 0;
+
+	do {
+		/*Recensement du front*/
+		nodes.clear();
+		for(unsigned int i = 0; i < m_active_nodes.slotCount(); ++i) {
+			unsigned int n = m_active_nodes.at(i);
+			if(n != NO_NODE)
+				nodes.push_back(n);
+		}
+
+		/*Transformations demandées par le critère (lecture seule)*/
+		int nbNodes = int(nodes.size());
+		action.assign(nbNodes, NONE);
+		#pragma omp parallel for schedule(static)
+		for(int i = 0; i < nbNodes; ++i) {
+			unsigned int n = nodes[i];
+			if(wanted(n)) {
+				if(m_nodes.getVSplit(n) != NO_SPLIT)
+					action[i] = REFINE;
+				continue;
 			}
-			if(non_transformation) {
-				it = it_back;
+			//La paire est examinée depuis son fils gauche seulement
+			unsigned int parent = m_nodes.getParent(n);
+			if(parent == NO_NODE || m_nodes.getLeftChild(parent) != n)
+				continue;
+			unsigned int child_right = m_nodes.getRightChild(parent);
+			if(m_nodes.isActive(child_right) && !wanted(parent) && !wanted(child_right))
+				action[i] = COARSEN;
+		}
+
+		/*Application, séquentielle*/
+		applied = 0;
+		for(int i = 0; i < nbNodes; ++i) {
+			if(action[i] == REFINE) {
+				if(refine(nodes[i]))
+					++applied;
+				else
+					m_blockedRefine.push_back(nodes[i]);
 			}
+			else if(action[i] == COARSEN && coarsen(nodes[i]))
+				++applied;
 		}
-		else {
-			++it;
+
+		/*Raffinements refusés : retentés au tour suivant, forcés si le front est stable*/
+		if(applied > 0) {
+			m_blockedRefine.clear();
+			continue;
+		}
+		while(!m_blockedRefine.empty()) {
+			unsigned int n = m_blockedRefine.back();
+			m_blockedRefine.pop_back();
+			if(!m_nodes.isActive(n) || forced[n])
+				continue;
+			forced[n] = true;
+			forceRefine(n);
+			if(!m_nodes.isActive(n))
+				++applied;
 		}
+	} while(applied > 0 && !m_active_nodes.empty());
+}
+
+/*
+ * Mise à jour incrémentale après un déplacement de la boîte depuis [previousMin ;
+ * previousMax], le front étant à jour pour cette ancienne boîte : seule la
+ * différence symétrique des deux boîtes est parcourue (raffinement dans le volume
+ * nouvellement couvert, simplification dans le volume découvert). Le travail suit
+ * l'amplitude du déplacement, pas la taille du modèle.
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::updateRefinement(const VEC3& previousMin, const VEC3& previousMax) {
+	if(m_spheres.size() != m_nodes.size()) {
+		m_lastBoxValid = false;
+		updateRefinement();
+		return;
 	}
+	m_lastBoxMin = previousMin;
+	m_lastBoxMax = previousMax;
+	m_lastBoxValid = true;
+	updateRefinement();
 }
 
+/*
+ * Changement de critère : le front est entièrement réévalué à la mise à jour suivante
+ */
 template <typename PFP>
-std::list<Node*>::iterator VDProgressiveMesh<PFP>::forceRefine(Node* n) {
-	std::stack<Node*>* pile = new std::stack<Node*>();
-	pile->push(n);
-	Node* n1;
-	bool stop = false;
-	std::list<Node*>::iterator res = m_active_nodes.end();
-	while(pile->size()>0) {
-		n1 = pile->top();
-		stop = false;
-		if(n1==0) {
-			pile->pop();
-			//CGoGNout << "Element illégal" << CGoGNendl;
+void VDProgressiveMesh<PFP>::setRefinementCriterion(RefinementCriterion criterion) {
+	if(criterion == m_criterion)
+		return;
+	m_criterion = criterion;
+	resetRefinementState();
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::setView(const ViewCriterion& view) {
+	if(view == m_view)
+		return;
+	m_view = view;
+	m_criterionChanged = true;
+}
+
+/*
+ * Décroissance du niveau de détail du critère gradué : la politique est figée dans
+ * le type du test, instancié une fois pour toutes ici
+ */
+template <typename PFP>
+template <typename Falloff>
+void VDProgressiveMesh<PFP>::setGradedFalloff(const Falloff& falloff) {
+	delete m_graded;
+	m_graded = new GradedSlice<Falloff>(falloff);
+	m_criterionChanged = true;
+}
+
+/*
+ * Distance d'un point à la boîte d'intérêt et aux régions, bornée par maxDistance
+ */
+template <typename PFP>
+float VDProgressiveMesh<PFP>::regionDistance(const VEC3& p, float maxDistance) {
+	return std::min(m_bb->distance(p), m_regions.distance(p, maxDistance));
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::resetRefinementState() {
+	if(m_scanPending)
+		m_active_nodes.endScan();
+	m_scanPending = false;
+	m_scanCursor = 0;
+	m_pending.clear();
+	m_pendingRegion.clear();
+	m_blockedRefine.clear();
+	m_blockedCoarsen.clear();
+	m_lastBoxValid = false;
+	m_criterionChanged = true;
+}
+
+/*
+ * Régions d'intérêt supplémentaires. Chaque modification ajoute au travail en attente
+ * la boîte englobante de la région avant et après : hors de ce volume, l'appartenance
+ * d'un point aux régions n'a pas changé.
+ */
+template <typename PFP>
+unsigned int VDProgressiveMesh<PFP>::addInterestBox(const VEC3& pos_min, const VEC3& pos_max) {
+	unsigned int h = m_regions.addBox(pos_min, pos_max);
+	regionChanged(m_regions.get(h));
+	return h;
+}
+
+template <typename PFP>
+unsigned int VDProgressiveMesh<PFP>::addInterestSphere(const VEC3& center, float radius) {
+	unsigned int h = m_regions.addSphere(center, radius);
+	regionChanged(m_regions.get(h));
+	return h;
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::moveInterestBox(unsigned int region, const VEC3& pos_min, const VEC3& pos_max) {
+	if(!m_regions.isValid(region))
+		return;
+	regionChanged(m_regions.get(region));
+	m_regions.moveBox(region, pos_min, pos_max);
+	regionChanged(m_regions.get(region));
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::moveInterestSphere(unsigned int region, const VEC3& center, float radius) {
+	if(!m_regions.isValid(region))
+		return;
+	regionChanged(m_regions.get(region));
+	m_regions.moveSphere(region, center, radius);
+	regionChanged(m_regions.get(region));
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::removeInterestRegion(unsigned int region) {
+	//Poignée déjà retirée (ou régions vidées) : sans effet
+	if(!m_regions.isValid(region))
+		return;
+	regionChanged(m_regions.get(region));
+	m_regions.remove(region);
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::regionChanged(const InterestRegion& region) {
+	if(m_criterion == CRITERION_GRADED)
+		m_criterionChanged = true;
+	//Sans état incrémental valide, la mise à jour suivante parcourt tout le front
+	if(m_criterion != CRITERION_BOX || !m_lastBoxValid)
+		return;
+	UpdateRegion changed;
+	changed.addBox(region.pos_min, region.pos_max);
+	pushRegion(changed);
+}
+
+/*
+ * Critères du parcours complet pour un noeud actif : raffinement si le critère le
+ * demande, simplification s'il ne le demande ni pour son parent ni pour les deux
+ * fils de celui-ci. Renvoie vrai si une transformation a eu lieu ; une transformation
+ * refusée par la topologie est notée pour être retentée.
+ */
+template <typename PFP>
+template <typename Criterion>
+bool VDProgressiveMesh<PFP>::updateNode(unsigned int n, const Criterion& wanted) {
+	if(wanted(n)) {
+		//Si le noeud est à raffiner (dans la boîte d'intérêt)
+		if(refine(n))
+			return true;
+		if(m_nodes.getVSplit(n) != NO_SPLIT)
+			m_blockedRefine.push_back(n);
+		return false;
+	}
+	//Si le noeud n'est pas à raffiner
+	unsigned int parent = m_nodes.getParent(n);
+	if(parent != NO_NODE) {
+		unsigned int child_left = m_nodes.getLeftChild(parent);	//Possibilité d'être le noeud courant
+		unsigned int child_right = m_nodes.getRightChild(parent);	//Possibilité d'être le noeud courant
+		if(		!wanted(parent)
+			&&	!wanted(child_left)
+			&& 	!wanted(child_right)) {
+			//Si le noeud a un parent qui n'est pas à raffiner
+			if(coarsen(n))
+				return true;
+			if(m_nodes.isActive(child_left) && m_nodes.isActive(child_right))
+				m_blockedCoarsen.push_back(parent);
 		}
-		else {
-			if(n1->getRightChild() && n1->getLeftChild()) {
-				VSplit<PFP>* vs = n1->getVSplit();
-				Dart d = vs->getEdge();
-				if(!inactiveMarker.isMarked(d)) {
-					//Si la transformation a déjà été faite
-					pile->pop();
-					stop = true;
-					//CGoGNout << "La transformation a déjà été effectuée" << CGoGNendl;
-				}
-			}
-			if(!stop) {
-				if(!n1->isActive()) {
-					//le noeud n'est pas encore actif
-					if(!searchChildActive(n1)) {
-						//Aucun des enfants n'est actif
-						//CGoGNout << "Aucun des fils n'est actif" << CGoGNendl;
-						std::list<Node*>::iterator parent_actif = searchParentActive(n1);
-						if(parent_actif!=m_active_nodes.end()) {
-							pile->push(*parent_actif);
-						}
-						else {
-							pile->pop();
-							//CGoGNout << "Aucun des parents n'est actif" << CGoGNendl;
-						}
-					}
-					else {
-						//CGoGNout << "Au moins 1 des fils est actif" << CGoGNendl;
-						pile->pop();
-					}
-				}
-				else if((res = refine(n1))!=m_active_nodes.end()) {
-					//si la transformation était légale et qu'elle a réussi
-					pile->pop();
-					//CGoGNout << "La transformation a réussi" << CGoGNendl;
-				}
-				else {
-					VSplit<PFP>* vs = n1->getVSplit();
-					if(vs) {
-						Dart d1 = vs->getOppositeLeftEdge();
-						Dart d1_1 = m_map.phi_1(d1);
-						Dart d2 = m_map.phi_1(vs->getLeftEdge());
-						Dart dd1 = vs->getOppositeRightEdge();
-						Dart dd1_1 = m_map.phi_1(dd1);
-						Dart dd2 = m_map.phi_1(vs->getRightEdge());
-
-						Node* n_d1 = noeud[d1].node;
-						Node* n_d2 = noeud[d2].node;
-						Node* n_dd1 = noeud[dd1].node;
-						Node* n_dd2 = noeud[dd2].node;
-
-						if(		!inactiveMarker.isMarked(d1) && !inactiveMarker.isMarked(d2)
-							&&	!inactiveMarker.isMarked(dd1) && !inactiveMarker.isMarked(dd2)
-							&& !inactiveMarker.isMarked(d1_1) && !inactiveMarker.isMarked(dd1_1)) {
-							//CGoGNout << "Pop : " << pile->size()  << CGoGNendl;
-							//CGoGNout << vs->getEdge() << CGoGNendl;
-							pile->pop();
-						}
-						else {
-							if(inactiveMarker.isMarked(d1)) {
-								pile->push(n_d1);
-								//CGoGNout << "On passe la : d1" << CGoGNendl;
-							}
-							if(inactiveMarker.isMarked(d2)) {
-								pile->push(n_d2);
-								//CGoGNout << "On passe la : d2" << CGoGNendl;
-							}
-							if(inactiveMarker.isMarked(dd1)) {
-								pile->push(n_dd1);
-								//CGoGNout << "On passe la : dd1 : " << n_dd1 << CGoGNendl;
-							}
-							if(inactiveMarker.isMarked(dd2)) {
-								pile->push(n_dd2);
-								//CGoGNout << "On passe la : dd2 : " << n_dd2 << CGoGNendl;
-							}
-							if(inactiveMarker.isMarked(d1_1)) {
-								pile->push(n_d1);
-								//CGoGNout << "On passe la : d1_1" << CGoGNendl;
-							}
-							if(inactiveMarker.isMarked(dd1_1)) {
-								pile->push(n_d1);
-								//CGoGNout << "On passe la : dd1_1" << CGoGNendl;
-							}
-						}
-					}
-					else {
-						pile->pop();
-					}
-				}
-			}
+	}
+	return false;
+}
+
+/*
+ * Parcours complet du front, repris au curseur. Le parcours reste ouvert sur le
+ * front d'un appel à l'autre : les noeuds gardent leur case, et ceux ajoutés en fin
+ * de front (fils ou parents) sont visités eux aussi, si bien que le parcours amène
+ * le front à l'état stable vis-à-vis de la boîte (les raffinements refusés par la
+ * topologie sont ensuite forcés, voir processBlocked).
+ */
+template <typename PFP>
+template <typename Criterion>
+bool VDProgressiveMesh<PFP>::processScan(RefinementSlice& slice, const Criterion& wanted) {
+	VDPM_TIMER(PHASE_SCAN);
+	while(m_scanCursor < m_active_nodes.slotCount()) {
+		if(slice.exhausted())
+			return false;
+		unsigned int n = m_active_nodes.at(m_scanCursor++);
+		if(n == NO_NODE) {
+			//Case libérée pendant le parcours
+			continue;
 		}
+		if(updateNode(n, wanted))
+			slice.operation();
 	}
-	return res;
+	m_active_nodes.endScan();
+	m_scanPending = false;
+	return true;
 }
 
+/*
+ * Ajoute au travail en attente les racines touchées par la région, après les
+ * simplifications refusées jusque-là (examinées en dernier, une fois la région traitée)
+ */
 template <typename PFP>
-bool VDProgressiveMesh<PFP>::searchChildActive(Node* noeud) {
-	bool res = false;
-	if(noeud->getRightChild()) {
-		if(noeud->getRightChild()->isActive()) {
-			res = true;
+void VDProgressiveMesh<PFP>::pushRegion(const UpdateRegion& region) {
+	if(region.empty())
+		return;
+	for(unsigned int i = 0; i < m_blockedCoarsen.size(); ++i)
+		m_pending.push_back(std::make_pair(m_blockedCoarsen[i], true));
+	m_blockedCoarsen.clear();
+	m_pendingRegion.addRegion(region);
+	std::vector<unsigned int> roots;
+	m_rootHierarchy.query(region, m_spheres, roots);
+	for(std::vector<unsigned int>::iterator it = roots.begin(); it != roots.end(); ++it)
+		m_pending.push_back(std::make_pair(*it, false));
+}
+
+/*
+ * Descente limitée à la région en attente, dans les sous-arbres dont la sphère la
+ * touche. Les critères sont ceux du parcours complet : un noeud actif dont le sommet
+ * est dans la boîte est raffiné (puis ses fils à leur tour), et, en remontant, une
+ * paire de fils actifs est simplifiée si les sommets du parent et des deux fils sont
+ * hors de la boîte. Les transformations refusées par la topologie sont notées : un
+ * noeud qui reste couvert par la boîte n'est plus dans aucune différence symétrique,
+ * et serait sinon laissé sous-raffiné pour de bon (voir processBlocked).
+ */
+template <typename PFP>
+template <typename Criterion>
+bool VDProgressiveMesh<PFP>::processPending(RefinementSlice& slice, const Criterion& wanted) {
+	VDPM_TIMER(PHASE_PENDING);
+	//Pile de (noeud, sous-arbres déjà traités)
+	while(!m_pending.empty()) {
+		if(slice.exhausted())
+			return false;
+		unsigned int n = m_pending.back().first;
+		bool done = m_pending.back().second;
+		m_pending.pop_back();
+
+		unsigned int child_left = m_nodes.getLeftChild(n);
+		unsigned int child_right = m_nodes.getRightChild(n);
+
+		if(m_nodes.isActive(n)) {
+			if(!wanted(n))
+				continue;
+			if(refine(n)) {
+				slice.operation();
+				//Les fils, devenus actifs, sont examinés à leur tour
+				m_pending.push_back(std::make_pair(child_right, false));
+				m_pending.push_back(std::make_pair(child_left, false));
+			}
+			else if(child_left != NO_NODE)
+				m_blockedRefine.push_back(n);
+			continue;
+		}
+		if(child_left == NO_NODE)
+			continue;
+
+		if(!done) {
+			//Noeud au-dessus du front : descente dans les fils touchés par la région
+			m_pending.push_back(std::make_pair(n, true));
+			if(m_pendingRegion.intersects(m_spheres[child_right]))
+				m_pending.push_back(std::make_pair(child_right, false));
+			if(m_pendingRegion.intersects(m_spheres[child_left]))
+				m_pending.push_back(std::make_pair(child_left, false));
+			continue;
 		}
-		else {
-			res = searchChildActive(noeud->getRightChild());
+
+		//Sous-arbres traités : simplification de la paire de fils
+		if(		m_nodes.isActive(child_left) && m_nodes.isActive(child_right)
+			&&	!wanted(n)
+			&&	!wanted(child_left)
+			&&	!wanted(child_right)) {
+			if(coarsen(child_left))
+				slice.operation();
+			else
+				m_blockedCoarsen.push_back(n);
 		}
 	}
-	if(!res && noeud->getLeftChild()) {
-		if(noeud->getLeftChild()->isActive()) {
-			res = true;
+	m_pendingRegion.clear();
+	return true;
+}
+
+/*
+ * Raffinements refusés par la topologie : les voisins dont ils dépendent sont raffinés
+ * d'abord (forceRefine), puis les fils devenus actifs rejoignent le travail en attente.
+ * Le front n'est pas convergé tant qu'il en reste. Un noeud que forceRefine ne peut
+ * rendre raffinable (dépendance hors de la forêt) est abandonné, comme dans le parcours
+ * complet.
+ */
+template <typename PFP>
+template <typename Criterion>
+bool VDProgressiveMesh<PFP>::processBlocked(RefinementSlice& slice, const Criterion& wanted) {
+	while(!m_blockedRefine.empty()) {
+		if(slice.exhausted())
+			return false;
+		unsigned int n = m_blockedRefine.back();
+		m_blockedRefine.pop_back();
+		if(!m_nodes.isActive(n) || !wanted(n))
+			continue;
+		forceRefine(n);
+		if(!m_nodes.isActive(n)) {
+			slice.operation();
+			m_pending.push_back(std::make_pair(m_nodes.getRightChild(n), false));
+			m_pending.push_back(std::make_pair(m_nodes.getLeftChild(n), false));
 		}
-		else {
-			res = searchChildActive(noeud->getLeftChild());
+	}
+	return true;
+}
+
+/*
+ * Sphères englobantes et erreurs géométriques des sous-arbres, calculées dans l'ordre
+ * du pool (les fils précèdent leur parent), puis hiérarchie des racines.
+ * L'erreur d'un noeud majore la distance entre son sommet et tout sommet de son
+ * sous-arbre : max sur les fils de (distance au fils + erreur du fils).
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::computeBounds() {
+	VDPM_TIMER(PHASE_BOUNDS);
+	m_spheres.resize(m_nodes.size());
+	m_errors.resize(m_nodes.size());
+	if(m_cones.size() != m_nodes.size()) {
+		//Cônes inconnus : aucun rejet des faces arrière
+		m_cones.assign(m_nodes.size(), NormalCone(VEC3(0.0f, 0.0f, 1.0f), HALF_PI));
+	}
+	std::vector<unsigned int> roots;
+	for(unsigned int n = 0; n < m_nodes.size(); ++n) {
+		const VEC3& p = positionsTable[m_nodes.getVertex(n)];
+		BoundingSphere s(p, 0.0f);
+		float error = 0.0f;
+		unsigned int child_left = m_nodes.getLeftChild(n);
+		unsigned int child_right = m_nodes.getRightChild(n);
+		if(child_left != NO_NODE) {
+			s = BoundingSphere::merge(s, m_spheres[child_left]);
+			s = BoundingSphere::merge(s, m_spheres[child_right]);
+			error = std::max(
+				(positionsTable[m_nodes.getVertex(child_left)] - p).norm() + m_errors[child_left],
+				(positionsTable[m_nodes.getVertex(child_right)] - p).norm() + m_errors[child_right]);
 		}
+		m_spheres[n] = s;
+		m_errors[n] = error;
+		if(m_nodes.getParent(n) == NO_NODE)
+			roots.push_back(n);
 	}
-	return res;
+	m_rootHierarchy.build(roots, m_spheres);
+	resetRefinementState();
+	VDPM_SET(PROF_FRONT_SIZE, m_active_nodes.size());
+	//Nouvelle hiérarchie (construite ou chargée) : maillage entièrement renouvelé
+	if(m_trackChanges)
+		m_changes.requestRebuild();
 }
 
+/*
+ * Rend le noeud n actif (s'il est sous le front) en raffinant ses ancêtres, ainsi que
+ * les noeuds voisins dont dépend la légalité de chaque raffinement. Parcours itératif
+ * sur une pile réutilisée où chaque noeud figure au plus une fois : un noeud déjà
+ * présent est remonté au sommet, son ancienne place étant laissée vide (NO_NODE).
+ */
 template <typename PFP>
-std::list<Node*>::iterator VDProgressiveMesh<PFP>::searchParentActive(Node* noeud) {
-	std::list<Node*>::iterator res = m_active_nodes.end();
-	if(noeud->getParent()) {
-		if(noeud->getParent()->isActive()) {
-			res = noeud->getParent()->getCurrentPosition();
+bool VDProgressiveMesh<PFP>::forceRefine(unsigned int n) {
+	VDPM_TIMER(PHASE_FORCE_REFINE);
+	VDPM_COUNT(PROF_FORCE_CALLS);
+	if(m_forcePos.size() != m_nodes.size())
+		m_forcePos.assign(m_nodes.size(), NO_SLOT);
+	m_forcePile.clear();
+	pushForce(n);
+	bool res = false;
+	while(!m_forcePile.empty()) {
+		unsigned int n1 = m_forcePile.back();
+		if(n1 == NO_NODE) {
+			//Place libérée par un noeud remonté au sommet
+			m_forcePile.pop_back();
+			continue;
+		}
+		if(m_nodes.getVSplit(n1) != NO_SPLIT
+		&& !inactiveMarker.isMarked(m_splits[m_nodes.getVSplit(n1)].getEdge())) {
+			//La transformation a déjà été effectuée
+			popForce();
+			continue;
+		}
+		if(!m_nodes.isActive(n1)) {
+			//Sous le front : raffinement préalable de l'ancêtre actif.
+			//Sans ancêtre actif, le noeud est au-dessus du front (un de ses fils est actif)
+			unsigned int parent_actif = searchParentActive(n1);
+			if(parent_actif != NO_NODE)
+				pushForce(parent_actif);
+			else
+				popForce();
+			continue;
+		}
+		if((res = refine(n1))) {
+			popForce();
+			continue;
 		}
-		else {
-			res = searchParentActive(noeud->getParent());
+		if(m_nodes.getVSplit(n1) == NO_SPLIT) {
+			popForce();
+			continue;
 		}
 
+		//Raffinement illégal : les noeuds des faces voisines encore inactives d'abord
+		const VSplit& vs = m_splits[m_nodes.getVSplit(n1)];
+		Dart d1 = getOppositeLeftEdge(vs);
+		Dart d1_1 = m_map.phi_1(d1);
+		Dart d2 = m_map.phi_1(vs.getLeftEdge());
+		Dart dd1 = getOppositeRightEdge(vs);
+		Dart dd1_1 = m_map.phi_1(dd1);
+		Dart dd2 = m_map.phi_1(vs.getRightEdge());
+
+		Dart blocking[6] = { d1, d2, dd1, dd2, d1_1, dd1_1 };
+		bool blocked = false;
+		for(unsigned int i = 0; i < 6; ++i) {
+			if(!inactiveMarker.isMarked(blocking[i]))
+				continue;
+			blocked = true;
+			unsigned int m = noeud[blocking[i]].node;
+			if(m != NO_NODE && m_forcePile.back() != m)
+				pushForce(m);
+		}
+		if(!blocked)
+			popForce();
 	}
 	return res;
 }
 
+template <typename PFP>
+void VDProgressiveMesh<PFP>::pushForce(unsigned int n) {
+	if(n == NO_NODE)
+		return;
+	if(m_forcePos[n] != NO_SLOT)
+		m_forcePile[m_forcePos[n]] = NO_NODE;
+	m_forcePos[n] = m_forcePile.size();
+	m_forcePile.push_back(n);
+	VDPM_MAX(PROF_FORCE_MAX_DEPTH, m_forcePile.size());
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::popForce() {
+	m_forcePos[m_forcePile.back()] = NO_SLOT;
+	m_forcePile.pop_back();
+}
+
+/*
+ * Vrai si un descendant de noeud est actif. Le front étant une coupe de chaque arbre,
+ * c'est le cas exactement quand ni le noeud ni aucun de ses ancêtres n'est actif.
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::searchChildActive(unsigned int noeud) {
+	return m_nodes.getLeftChild(noeud) != NO_NODE && !m_nodes.isActive(noeud) && searchParentActive(noeud) == NO_NODE;
+}
+
+/*
+ * Ancêtre actif de noeud (NO_NODE s'il n'y en a pas). Remontée jusqu'au premier noeud
+ * actif ou dont l'ancêtre mémorisé est encore actif, puis mémorisation du résultat le
+ * long du chemin parcouru : le coût est amorti et ne dépend que des déplacements du
+ * front depuis la dernière recherche, pas de la profondeur de l'arbre.
+ */
+template <typename PFP>
+unsigned int VDProgressiveMesh<PFP>::searchParentActive(unsigned int noeud) {
+	unsigned int res = m_nodes.getActiveAncestor(noeud);
+	if(res != NO_NODE)
+		return res;
+	unsigned int parent = m_nodes.getParent(noeud);
+	while(parent != NO_NODE) {
+		if(m_nodes.isActive(parent)) {
+			res = parent;
+			break;
+		}
+		res = m_nodes.getActiveAncestor(parent);
+		if(res != NO_NODE)
+			break;
+		parent = m_nodes.getParent(parent);
+	}
+	if(res == NO_NODE)
+		return res;
+	//Compression du chemin parcouru
+	for(unsigned int m = noeud; m != parent; m = m_nodes.getParent(m))
+		m_nodes.setActiveAncestor(m, res);
+	return res;
+}
+
+/*
+ * Histogramme des hauteurs des arbres de la forêt : histogram[h] est le nombre de
+ * racines de hauteur h
+ */
+template <typename PFP>
+void VDProgressiveMesh<PFP>::getHeightDistribution(std::vector<unsigned int>& histogram)
+{
+    histogram.assign(m_height + 1, 0);
+    for(unsigned int n = 0; n < m_nodes.size(); ++n) {
+        if(m_nodes.getParent(n) == NO_NODE)
+            ++histogram[m_nodes.getHeight(n)];
+    }
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::printHeightDistribution()
+{
+    std::vector<unsigned int> histogram;
+    getHeightDistribution(histogram);
+
+    unsigned int nbTrees = 0;
+    unsigned long long sum = 0;
+    for(unsigned int h = 0; h < histogram.size(); ++h) {
+        nbTrees += histogram[h];
+        sum += (unsigned long long)h * histogram[h];
+    }
+    CGoGNout << "Distribution des hauteurs (" << nbTrees << " arbres, moyenne "
+             << (nbTrees ? double(sum) / nbTrees : 0.) << ") :" << CGoGNendl;
+    for(unsigned int h = 0; h < histogram.size(); ++h) {
+        if(histogram[h])
+            CGoGNout << "  " << h << " : " << histogram[h] << CGoGNendl;
+    }
+}
+
+template <typename PFP>
+void VDProgressiveMesh<PFP>::printMemoryUsage()
+{
+    size_t nodes = getNodesMemory();
+    size_t splits = getSplitsMemory();
+    size_t front = getFrontMemory();
+    size_t bounds = getBoundsMemory();
+    CGoGNout << "Mémoire de la hiérarchie : " << (nodes + splits + front + bounds) / 1024 << " Ko" << CGoGNendl;
+    CGoGNout << "  noeuds : " << m_nodes.size() << " x " << (m_nodes.size() ? double(nodes) / m_nodes.size() : 0.)
+             << " o (" << nodes / 1024 << " Ko)" << CGoGNendl;
+    CGoGNout << "  VSplit : " << m_splits.size() << " x " << sizeof(VSplit)
+             << " o (" << splits / 1024 << " Ko alloués)" << CGoGNendl;
+    CGoGNout << "  front : " << m_active_nodes.size() << " noeuds actifs (" << front / 1024 << " Ko)" << CGoGNendl;
+    CGoGNout << "  sphères, cônes et erreurs : " << m_spheres.size() << " + " << m_rootHierarchy.nbRoots()
+             << " racines (" << bounds / 1024 << " Ko)" << CGoGNendl;
+}
+
+/*CACHE DE LA HIERARCHIE*/
+template <typename PFP>
+unsigned long long VDProgressiveMesh<PFP>::hierarchyKey(unsigned long long meshHash, unsigned int percentWantedVertices)
+{
+    unsigned long long h = fnv1aValue(CACHE_VERSION, meshHash);
+    h = fnv1aValue(percentWantedVertices, h);
+    h = fnv1aValue((unsigned int)m_buildMode, h);
+    h = fnv1aValue((unsigned int)m_ordering, h);
+    h = fnv1aValue(m_seed, h);
+    h = fnv1aValue(m_balanceWeight, h);
+    return h;
+}
+
+/*
+ * Enregistre la forêt (liens, VSplit, état actif), le marqueur des brins inactifs, les
+ * lignes utilisées de la carte et, à côté, la carte contractée au format binaire CGoGN
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::saveHierarchy(const std::string& filename, unsigned long long key)
+{
+    std::string mapFile = filename + ".map";
+    if(!m_map.saveMapBin(mapFile))
+        return false;
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = CACHE_VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    header.key = key;
+    header.mapSize = fileSize(mapFile);
+    std::string positionName = positionsTable.name();
+    header.positionName = fnv1a(positionName.data(), positionName.size());
+    header.nbNodes = m_nodes.size();
+    header.height = m_height;
+
+    std::vector<unsigned int> usedLines;
+    AttributeContainer& dartCont = m_map.template getAttributeContainer<DART>();
+    AttributeContainer& vertexCont = m_map.template getAttributeContainer<VERTEX>();
+    AttributeContainer& edgeCont = m_map.template getAttributeContainer<EDGE>();
+    header.dartLines = dartCont.realEnd();
+    header.vertexLines = vertexCont.realEnd();
+    header.edgeLines = edgeCont.realEnd();
+    appendUsedLines(dartCont, usedLines);
+    appendUsedLines(vertexCont, usedLines);
+    appendUsedLines(edgeCont, usedLines);
+
+    std::vector<unsigned int> inactiveDarts;
+    for(Dart d = m_map.begin(); d != m_map.end(); m_map.next(d)) {
+        if(inactiveMarker.isMarked(d))
+            inactiveDarts.push_back(d.index);
+    }
+    header.nbInactiveDarts = inactiveDarts.size();
+
+    //Les indices du pool sont ceux du fichier (NO_NODE == CACHE_NONE)
+    std::vector<NodeRecord> records(m_nodes.size());
+    for(unsigned int n = 0; n < m_nodes.size(); ++n) {
+        NodeRecord& r = records[n];
+        r.parent = m_nodes.getParent(n);
+        r.leftChild = m_nodes.getLeftChild(n);
+        r.rightChild = m_nodes.getRightChild(n);
+        r.vertex = m_nodes.getVertex(n);
+        r.height = m_nodes.getHeight(n);
+        r.active = m_nodes.isActive(n) ? 1 : 0;
+        const VSplit* vs = m_nodes.getVSplit(n) != NO_SPLIT ? &m_splits[m_nodes.getVSplit(n)] : NULL;
+        r.edge = vs ? vs->getEdge().index : CACHE_NONE;
+        r.rightEdge = vs ? vs->getRightEdge().index : CACHE_NONE;
+        r.leftEdge = vs ? vs->getLeftEdge().index : CACHE_NONE;
+        r.approxV = vs ? vs->getApproxV() : EMBNULL;
+        r.approxE1 = vs ? vs->getApproxE1() : EMBNULL;
+        r.approxE2 = vs ? vs->getApproxE2() : EMBNULL;
+        const NormalCone& cone = m_cones[n];
+        r.coneAxis[0] = cone.axis[0];
+        r.coneAxis[1] = cone.axis[1];
+        r.coneAxis[2] = cone.axis[2];
+        r.coneAngle = cone.angle;
+        const VEC3& nrm = m_nodeNormals[n];
+        r.normal[0] = nrm[0];
+        r.normal[1] = nrm[1];
+        r.normal[2] = nrm[2];
+    }
+
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if(!out.good())
+        return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if(!records.empty())
+        out.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(NodeRecord));
+    if(!inactiveDarts.empty())
+        out.write(reinterpret_cast<const char*>(&inactiveDarts[0]), inactiveDarts.size() * sizeof(unsigned int));
+    if(!usedLines.empty())
+        out.write(reinterpret_cast<const char*>(&usedLines[0]), usedLines.size() * sizeof(unsigned int));
+    return out.good();
+}
+
+/*
+ * Recharge une forêt enregistrée par saveHierarchy à la place de createPM.
+ * Le fichier est projeté en mémoire et validé (signature, version, clé, tailles,
+ * liens de la forêt, indices de brins et de lignes) avant que la carte contractée,
+ * lue une seule fois, ne remplace la carte courante : celle-ci reste disponible pour
+ * la reconstruction si le cache est refusé. Les noeuds sont recopiés dans le pool.
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::loadHierarchy(const std::string& filename, unsigned long long key)
+{
+    MappedFile file;
+    if(!file.open(filename) || file.size() < sizeof(CacheHeader))
+        return false;
+
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(file.data());
+    if(memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0
+    || header->version != CACHE_VERSION
+    || header->headerSize != sizeof(CacheHeader)
+    || header->key != key)
+        return false;
+    std::string positionName = positionsTable.name();
+    if(header->positionName != fnv1a(positionName.data(), positionName.size()))
+        return false;
+
+    size_t nbWords = size_t(usedLinesWords(header->dartLines)) + usedLinesWords(header->vertexLines)
+                   + usedLinesWords(header->edgeLines);
+    size_t expected = sizeof(CacheHeader)
+                    + size_t(header->nbNodes) * sizeof(NodeRecord)
+                    + (size_t(header->nbInactiveDarts) + nbWords) * sizeof(unsigned int);
+    std::string mapFile = filename + ".map";
+    if(file.size() != expected || fileSize(mapFile) != (long long)header->mapSize)
+        return false;
+
+    const NodeRecord* records = reinterpret_cast<const NodeRecord*>(file.data() + sizeof(CacheHeader));
+    const unsigned int* inactiveDarts = reinterpret_cast<const unsigned int*>(records + header->nbNodes);
+    const unsigned int* words = inactiveDarts + header->nbInactiveDarts;
+    UsedLines darts(words, header->dartLines);
+    words += usedLinesWords(header->dartLines);
+    UsedLines vertices(words, header->vertexLines);
+    words += usedLinesWords(header->vertexLines);
+    UsedLines edges(words, header->edgeLines);
+
+    if(!checkCache(records, header->nbNodes, inactiveDarts, header->nbInactiveDarts, darts, vertices, edges)) {
+        CGoGNerr << "invalid hierarchy cache " << filename << ", rebuilding" << CGoGNendl;
+        return false;
+    }
+
+    /*Remplacement de la carte : les attributs sont récupérés par leur nom*/
+    if(!m_map.loadMapBin(mapFile))
+        return false;
+    positionsTable = m_map.template getAttribute<VEC3, VERTEX>(positionName);
+    noeud = m_map.template getAttribute<EmbNode, VERTEX>("noeud");
+    if(!noeud.isValid())
+        noeud = m_map.template addAttribute<EmbNode, VERTEX>("noeud");
+
+    inactiveMarker.unmarkAll();
+    for(unsigned int i = 0; i < header->nbInactiveDarts; ++i)
+        inactiveMarker.mark(Dart(inactiveDarts[i]));
+
+    /*Reconstruction des noeuds et du front*/
+    //Les lignes référencées par les anciens VSplit ont disparu avec l'ancienne carte ;
+    //celles des VSplit rechargés le sont déjà dans la carte enregistrée
+    m_splits.clear();
+    m_nodes.clear();
+    m_active_nodes.clear();
+    m_nodes.reserve(header->nbNodes);
+    m_cones.resize(header->nbNodes);
+    m_nodeNormals.resize(header->nbNodes);
+    for(unsigned int i = 0; i < header->nbNodes; ++i) {
+        const NodeRecord& r = records[i];
+        unsigned int split = NO_SPLIT;
+        if(r.edge != CACHE_NONE) {
+            VSplit vs(Dart(r.edge), Dart(r.rightEdge), Dart(r.leftEdge));
+            vs.setApprox(r.approxV, r.approxE1, r.approxE2);
+            m_splits.push_back(vs);
+            split = m_splits.size() - 1;
+        }
+        unsigned int n = m_nodes.addNode(split, r.active != 0, r.vertex, r.height);
+        m_nodes.setParent(n, r.parent);
+        m_nodes.setLeftChild(n, r.leftChild);
+        m_nodes.setRightChild(n, r.rightChild);
+        noeud[r.vertex].node = n;
+        if(r.active)
+            m_active_nodes.insert(n);
+        m_cones[n] = NormalCone(VEC3(r.coneAxis[0], r.coneAxis[1], r.coneAxis[2]), r.coneAngle);
+        m_nodeNormals[n] = VEC3(r.normal[0], r.normal[1], r.normal[2]);
+    }
+    m_height = header->height;
+
+    //La hiérarchie est construite : le sélecteur n'est plus nécessaire
+    delete m_selector;
+    m_selector = NULL;
+
+    computeBounds();
+
+    CGoGNout << "Hiérarchie rechargée depuis " << filename << " : " << header->nbNodes << " noeuds, "
+             << m_active_nodes.size() << " actifs" << CGoGNendl;
+    printMemoryUsage();
+    return true;
+}
+
+/*
+ * Cohérence d'un cache :
+ *  - forêt : un parent vient après ses fils (ordre du pool, sur lequel compte
+ *    computeBounds), ce qui exclut les cycles, et chaque fils désigne son parent ;
+ *  - carte enregistrée : brins des VSplit et brins inactifs existants, sommets des
+ *    noeuds et lignes d'approximation utilisées dans leurs conteneurs
+ */
+template <typename PFP>
+bool VDProgressiveMesh<PFP>::checkCache(const NodeRecord* records, unsigned int nbNodes, const unsigned int* inactiveDarts, unsigned int nbInactiveDarts,
+                                        const UsedLines& darts, const UsedLines& vertices, const UsedLines& edges)
+{
+    for(unsigned int i = 0; i < nbNodes; ++i) {
+        const NodeRecord& r = records[i];
+        if((r.parent != CACHE_NONE && (r.parent <= i || r.parent >= nbNodes))
+        || ((r.leftChild == CACHE_NONE) != (r.rightChild == CACHE_NONE))
+        || ((r.leftChild == CACHE_NONE) != (r.edge == CACHE_NONE)))
+            return false;
+        if(!vertices.contains(r.vertex))
+            return false;
+        if(r.edge == CACHE_NONE)
+            continue;
+        if(r.leftChild >= i || r.rightChild >= i || r.leftChild == r.rightChild
+        || records[r.leftChild].parent != i || records[r.rightChild].parent != i)
+            return false;
+        if(!darts.contains(r.edge) || !darts.contains(r.rightEdge) || !darts.contains(r.leftEdge))
+            return false;
+        //Lignes d'approximation absentes (EMBNULL) admises, comme dans releaseSplits
+        if((r.approxV != EMBNULL && !vertices.contains(r.approxV))
+        || (r.approxE1 != EMBNULL && !edges.contains(r.approxE1))
+        || (r.approxE2 != EMBNULL && !edges.contains(r.approxE2)))
+            return false;
+    }
+    for(unsigned int i = 0; i < nbInactiveDarts; ++i) {
+        if(!darts.contains(inactiveDarts[i]))
+            return false;
+    }
+    return true;
+}
+
 /*FONCTIONS DE DEBOGAGE*/
 template <typename PFP>
 void VDProgressiveMesh<PFP>::drawForest() {
-    for(std::list<Node*>::iterator it = m_active_nodes.begin(); it != m_active_nodes.end(); ++it) {
+    for(unsigned int i = 0; i < m_active_nodes.slotCount(); ++i) {
         /*On parcourt l'ensemble des racines de la forêt*/
-        drawTree(*it);
+        drawTree(m_active_nodes.at(i));
         CGoGNout << CGoGNendl;
     } 
 }
 
 template <typename PFP>
-void VDProgressiveMesh<PFP>::drawTree(Node* node) {
-    CGoGNout << node->getVertex() << CGoGNflush;
-    if(node) {
-        if(node->getLeftChild()) {
+void VDProgressiveMesh<PFP>::drawTree(unsigned int node) {
+    if(node != NO_NODE) {
+        CGoGNout << m_nodes.getVertex(node) << CGoGNflush;
+        if(m_nodes.getLeftChild(node) != NO_NODE) {
             CGoGNout << " G( " << CGoGNflush;
-            drawTree(node->getLeftChild());
+            drawTree(m_nodes.getLeftChild(node));
             CGoGNout << " ) " << CGoGNflush;
         }
-        if(node->getRightChild()) {
+        if(m_nodes.getRightChild(node) != NO_NODE) {
             CGoGNout << " D( " << CGoGNflush;
-            drawTree(node->getRightChild());
+            drawTree(m_nodes.getRightChild(node));
             CGoGNout << " ) " << CGoGNflush;
         }
     }
@@ -610,11 +1902,14 @@ template <typename PFP>
 void VDProgressiveMesh<PFP>::drawFront() {
     CGoGNout << "Front courant : " << CGoGNendl;
     CGoGNout << "  " << m_active_nodes.size() << " noeuds actifs" << CGoGNendl;
-    for(std::list<Node*>::iterator it = m_active_nodes.begin(); it != m_active_nodes.end(); ++it) {
-        if(it!=--m_active_nodes.end())
-            CGoGNout << (*it)->getVertex() << " | " << CGoGNflush;
+    for(unsigned int i = 0; i < m_active_nodes.slotCount(); ++i) {
+        unsigned int n = m_active_nodes.at(i);
+        if(n == NO_NODE)
+            continue;
+        if(i+1 < m_active_nodes.slotCount())
+            CGoGNout << m_nodes.getVertex(n) << " | " << CGoGNflush;
         else
-            CGoGNout << (*it)->getVertex() <<  CGoGNendl;
+            CGoGNout << m_nodes.getVertex(n) <<  CGoGNendl;
     }
 }
 
@@ -23,6 +23,10 @@
 *******************************************************************************/
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <QTimer>
 
 #include "Utils/Qt/qtSimple.h"
 #include "ui_VDPMesh_App.h"
@@ -51,11 +55,18 @@
 
 #include "Utils/Qt/qtInputs.h"
 
+#include "glm/gtc/type_ptr.hpp"
+
 #include "Algo/Geometry/boundingbox.h"
 #include "Algo/Geometry/normal.h"
 #include "Algo/Geometry/convexity.h"
 
 #include "VDPMesh.h"
+#include "RefinementWorker.h"
+#include "FrontRender.h"
+#include "FrontNormals.h"
+#include "StreamingPM.h"
+#include "Profiler.h"
 #include "Node.h"
 
 namespace CGoGN
@@ -123,6 +134,39 @@ public:
     Algo::Surface::VDPMesh::VDProgressiveMesh<PFP>* m_pmesh;
     int max_level;
 
+    std::string m_meshFile;     //Fichier du maillage importé (clé du cache de hiérarchie)
+
+    //Copies épinglées de la boîte d'intérêt (poignée de région, affichage)
+    std::vector<std::pair<unsigned int, Box*> > m_pinnedRegions;
+
+    static const double REFINEMENT_SLICE;   //Durée d'une tranche de mise à jour (s)
+    bool m_refinementScheduled;             //Une tranche est programmée dans la boucle Qt
+    static const int PREFETCH_DELAY;        //Inactivité avant le raffinement spéculatif (ms)
+    static const float PREFETCH_LOOKAHEAD;  //Déplacements anticipés par le raffinement spéculatif
+    bool m_prefetchScheduled;
+    unsigned int m_boxMoves;                //Déplacements de la boîte demandés au clavier
+    unsigned int m_restCheckMoves;          //Valeur de m_boxMoves au dernier test d'immobilité
+
+    //Mise à jour du raffinement en tâche de fond (NULL si synchrone)
+    RefinementWorker<PFP>* m_worker;
+    FrontRender* m_frontRender;
+    FrontBuffers<PFP> m_frontBuffers;       //Primitives tenues à jour à partir des changements du maillage
+    FrontNormals<PFP> m_frontNormals;       //Normales revues autour des changements du maillage
+    bool m_nodeNormals;                     //Normales précalculées des noeuds plutôt que recalculées
+    CacheOrderedTriangles<PFP> m_orderedTriangles;  //Triangles réordonnés pour le cache des sommets
+    bool m_cacheOrder;
+    Box* m_targetBox;                       //Boîte d'intérêt visée par le thread de mise à jour
+    std::ofstream m_profileCSV;             //Instrumentation écrite à chaque trame (si ouvert)
+
+    void scheduleRefinement();
+    void schedulePrefetch();
+    void startWorker();
+    void stopWorker();
+    void drawPrimitives(Utils::GLSLShader* sh, int prim);
+    void updateView();
+    void applyCriterion();
+    void endProfileFrame();
+
 	VDPMesh_App() ;
 
 	void initGUI() ;
@@ -152,6 +196,20 @@ public slots:
     void slot_vertexNumber(int i);
     void slot_createPM();
     void slot_update();
+    void slot_continueRefinement();
+    void slot_viewDependent(bool b);
+    void slot_graded(bool b);
+    void slot_tolerance(double d);
+    void slot_parallelUpdate(bool b);
+    void slot_asyncUpdate(bool b);
+    void slot_snapshotReady();
+    void slot_prefetch();
+    void slot_prefetchEnabled(bool b);
+    void slot_boxAtRest();
+    void slot_nodeNormals(bool b);
+    void slot_cacheOrder(bool b);
+    void slot_profileCSV(bool b);
+    void slot_profileReset();
 };
 
 } // namespace VDPMesh
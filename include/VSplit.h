@@ -37,80 +37,48 @@ namespace Surface
 namespace VDPMesh
 {
 
-template <typename PFP>
+/*
+ * Enregistrement compact d'une contraction d'arête, sans référence à la carte.
+ * Seuls les brins qui ne se déduisent pas de la topologie courante sont conservés :
+ * l'arête contractée et les arêtes gauche et droite sur lesquelles les faces voisines
+ * sont recousues. Les arêtes opposées s'en déduisent par phi2 (voir
+ * VDProgressiveMesh::getOppositeLeftEdge). Les lignes d'approximation ne sont pas
+ * référencées ici : le VDProgressiveMesh propriétaire les référence à la contraction
+ * et les libère en bloc.
+ */
 class VSplit 
 {
-public:
-	typedef typename PFP::MAP MAP ;
-	typedef typename PFP::VEC3 VEC3 ;
-
 private:
-	MAP& m_map ;
 	Dart m_edge ;
 	Dart m_right_edge ;
 	Dart m_left_edge ;
-    Dart m_opposite_right_edge;
-    Dart m_opposite_left_edge;
 	unsigned int approxVertexId ;
 	unsigned int approxEdgeId1, approxEdgeId2 ;
 
 public:
-	VSplit(MAP& m, Dart e, Dart r, Dart l, Dart ro, Dart lo)
-		: m_map(m), m_edge(e), m_right_edge(r), m_left_edge(l), m_opposite_right_edge(ro), m_opposite_left_edge(lo), approxVertexId(EMBNULL), approxEdgeId1(EMBNULL), approxEdgeId2(EMBNULL)
+	VSplit(Dart e, Dart r, Dart l)
+		: m_edge(e), m_right_edge(r), m_left_edge(l), approxVertexId(EMBNULL), approxEdgeId1(EMBNULL), approxEdgeId2(EMBNULL)
 	{}
-	~VSplit()
-	{
-		AttributeContainer& cont = m_map.template getAttributeContainer<VERTEX>() ;
-		if(approxVertexId != EMBNULL) cont.unrefLine(approxVertexId) ;
-	}
 
-	Dart getEdge() { return m_edge ; }
-	Dart getLeftEdge() { return m_left_edge ; }
-	Dart getRightEdge() { return m_right_edge ; }
-	Dart getOppositeRightEdge() { return m_opposite_right_edge ; }
-	Dart getOppositeLeftEdge() { return m_opposite_left_edge ; }
+	Dart getEdge() const { return m_edge ; }
+	Dart getLeftEdge() const { return m_left_edge ; }
+	Dart getRightEdge() const { return m_right_edge ; }
 	void setEdge(Dart edge) { m_edge = edge ; }
 	void setLeftEdge(Dart edge) { m_left_edge = edge ; }
 	void setRightEdge(Dart edge) { m_right_edge = edge ; }
-	void setOppositeRightEdge(Dart edge) { m_opposite_right_edge = edge ; }
-	void setOppositeLeftEdge(Dart edge) { m_opposite_left_edge = edge ; }
-
-	unsigned int getApproxV() { return approxVertexId ; }
-	void setApproxV(unsigned int id)
-	{
-		if(approxVertexId == id) return ;
-		AttributeContainer& cont = m_map.template getAttributeContainer<VERTEX>() ;
-		if(approxVertexId != EMBNULL)
-			cont.unrefLine(approxVertexId) ;
-		if(id != EMBNULL) cont.refLine(id) ;
-		approxVertexId = id ;
-	}
 
-	unsigned int getApproxE1() { return approxEdgeId1 ; }
-	void setApproxE1(unsigned int id)
-	{
-		if(approxEdgeId1 == id) return ;
-		AttributeContainer& cont = m_map.template getAttributeContainer<EDGE>() ;
-		if(approxEdgeId1 != EMBNULL)
-			cont.unrefLine(approxEdgeId1) ;
-		if(id != EMBNULL) cont.refLine(id) ;
-		approxEdgeId1 = id ;
-	}
+	unsigned int getApproxV() const { return approxVertexId ; }
+	unsigned int getApproxE1() const { return approxEdgeId1 ; }
+	unsigned int getApproxE2() const { return approxEdgeId2 ; }
 
-	unsigned int getApproxE2() { return approxEdgeId2 ; }
-	void setApproxE2(unsigned int id)
+	void setApprox(unsigned int v, unsigned int e1, unsigned int e2)
 	{
-		if(approxEdgeId2 == id) return ;
-		AttributeContainer& cont = m_map.template getAttributeContainer<EDGE>() ;
-		if(approxEdgeId2 != EMBNULL)
-			cont.unrefLine(approxEdgeId2) ;
-		if(id != EMBNULL) cont.refLine(id) ;
-		approxEdgeId2 = id ;
+		approxVertexId = v ;
+		approxEdgeId1 = e1 ;
+		approxEdgeId2 = e2 ;
 	}
 
-    MAP& getMap() { return m_map; }
-
-    bool operator==(const VSplit& vs) 
+    bool operator==(const VSplit& vs) const
     {
         return m_edge==vs.m_edge && m_left_edge==vs.m_left_edge && m_right_edge==vs.m_right_edge;
     }
@@ -0,0 +1,445 @@
+ #ifndef __VERTEX_CACHE_H__
+ #define __VERTEX_CACHE_H__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "Node.h"
+#include "IndexBuffers.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * ACMR (nombre moyen de sommets transformés par triangle) d'une suite de triangles
+ * pour un cache FIFO de cacheSize sommets ; les triangles dégénérés sont ignorés.
+ * 3 sans aucune réutilisation, vers 0.5 pour un ordre idéal.
+ */
+inline float acmr(const std::vector<unsigned int>& indices, unsigned int cacheSize = 16) {
+    std::vector<unsigned int> inserted;     //Instant d'entrée dans le cache de chaque sommet
+    unsigned int time = 0;
+    unsigned int nbTriangles = 0;
+    for(unsigned int t = 0; t + 2 < indices.size(); t += 3) {
+        const unsigned int* v = &indices[t];
+        if(v[0] == v[1] || v[1] == v[2] || v[0] == v[2])
+            continue;
+        ++nbTriangles;
+        for(unsigned int k = 0; k < 3; ++k) {
+            if(v[k] >= inserted.size())
+                inserted.resize(v[k] + 1, NO_NODE);
+            if(inserted[v[k]] == NO_NODE || time - inserted[v[k]] >= cacheSize)
+                inserted[v[k]] = time++;
+        }
+    }
+    return nbTriangles > 0 ? float(time) / float(nbTriangles) : 0.0f;
+}
+
+/*
+ * Réordonnancement de triangles pour le cache des sommets transformés
+ * (algorithme glouton de T. Forsyth, "Linear-speed vertex cache optimisation") :
+ * le triangle émis est celui de meilleur score parmi ceux qui touchent le cache LRU
+ * simulé ; le score d'un sommet favorise les sommets récents du cache et ceux qui
+ * ont peu de triangles restants. Les tableaux de travail sont conservés d'un appel
+ * à l'autre.
+ */
+class ForsythOptimizer {
+    public:
+        static const int CACHE_SIZE = 32;
+
+        ForsythOptimizer() : m_currentStamp(0) {}
+
+        //Ajoute à out les nbTriangles triangles de in (3 indices chacun), réordonnés
+        void optimize(const unsigned int* in, unsigned int nbTriangles, std::vector<unsigned int>& out) {
+            if(nbTriangles == 0)
+                return;
+            remap(in, nbTriangles);
+            unsigned int nbVertices = m_global.size();
+
+            //Triangles de chaque sommet ; les m_live[v] premiers ne sont pas encore émis
+            m_live.assign(nbVertices, 0);
+            for(unsigned int i = 0; i < 3 * nbTriangles; ++i)
+                ++m_live[m_tri[i]];
+            m_adjOffset.resize(nbVertices + 1);
+            m_adjOffset[0] = 0;
+            for(unsigned int v = 0; v < nbVertices; ++v)
+                m_adjOffset[v + 1] = m_adjOffset[v] + m_live[v];
+            m_adj.resize(3 * nbTriangles);
+            m_fill.assign(m_adjOffset.begin(), m_adjOffset.end() - 1);
+            for(unsigned int i = 0; i < 3 * nbTriangles; ++i)
+                m_adj[m_fill[m_tri[i]]++] = i / 3;
+
+            m_cachePos.assign(nbVertices, -1);
+            m_score.resize(nbVertices);
+            for(unsigned int v = 0; v < nbVertices; ++v)
+                m_score[v] = vertexScore(-1, m_live[v]);
+            m_emitted.assign(nbTriangles, 0);
+            m_cache.clear();
+
+            int best = -1;
+            unsigned int cursor = 0;
+            for(unsigned int emitted = 0; emitted < nbTriangles; ++emitted) {
+                if(best < 0) {
+                    //Aucun triangle ne touche le cache : premier triangle restant
+                    while(m_emitted[cursor])
+                        ++cursor;
+                    best = cursor;
+                }
+                const unsigned int* tri = &m_tri[3 * best];
+                for(unsigned int k = 0; k < 3; ++k)
+                    out.push_back(m_global[tri[k]]);
+                m_emitted[best] = 1;
+                for(unsigned int k = 0; k < 3; ++k)
+                    removeAdjacency(tri[k], best);
+
+                //Cache LRU : les sommets du triangle en tête
+                m_newCache.assign(tri, tri + 3);
+                for(unsigned int i = 0; i < m_cache.size(); ++i) {
+                    unsigned int v = m_cache[i];
+                    if(v != tri[0] && v != tri[1] && v != tri[2])
+                        m_newCache.push_back(v);
+                }
+                for(unsigned int i = CACHE_SIZE; i < m_newCache.size(); ++i) {
+                    m_cachePos[m_newCache[i]] = -1;
+                    m_score[m_newCache[i]] = vertexScore(-1, m_live[m_newCache[i]]);
+                }
+                if(m_newCache.size() > (unsigned int)CACHE_SIZE)
+                    m_newCache.resize(CACHE_SIZE);
+                m_cache.swap(m_newCache);
+                for(unsigned int i = 0; i < m_cache.size(); ++i) {
+                    m_cachePos[m_cache[i]] = i;
+                    m_score[m_cache[i]] = vertexScore(i, m_live[m_cache[i]]);
+                }
+
+                //Meilleur triangle restant parmi ceux des sommets du cache
+                best = -1;
+                float bestScore = -1.0f;
+                for(unsigned int i = 0; i < m_cache.size(); ++i) {
+                    unsigned int v = m_cache[i];
+                    for(unsigned int a = m_adjOffset[v]; a < m_adjOffset[v] + m_live[v]; ++a) {
+                        unsigned int t = m_adj[a];
+                        float score = m_score[m_tri[3 * t]] + m_score[m_tri[3 * t + 1]] + m_score[m_tri[3 * t + 2]];
+                        if(score > bestScore) {
+                            bestScore = score;
+                            best = t;
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        /*Indices locaux (0..nbVertices-1) des sommets des triangles traités*/
+        std::vector<unsigned int> m_tri;
+        std::vector<unsigned int> m_global;     //Local -> indice d'origine
+        std::vector<unsigned int> m_local;      //Indice d'origine -> local (valide si m_stamp à jour)
+        std::vector<unsigned int> m_stamp;
+        unsigned int m_currentStamp;
+
+        std::vector<unsigned int> m_live;
+        std::vector<unsigned int> m_adjOffset;
+        std::vector<unsigned int> m_adj;
+        std::vector<unsigned int> m_fill;
+        std::vector<int> m_cachePos;
+        std::vector<float> m_score;
+        std::vector<unsigned char> m_emitted;
+        std::vector<unsigned int> m_cache;
+        std::vector<unsigned int> m_newCache;
+
+        static float vertexScore(int cachePos, unsigned int live) {
+            if(live == 0)
+                return -1.0f;
+            float score = 0.0f;
+            if(cachePos >= 0) {
+                if(cachePos < 3)
+                    score = 0.75f;  //Sommets du dernier triangle : légère pénalité contre les bandes
+                else
+                    score = std::pow(1.0f - float(cachePos - 3) / float(CACHE_SIZE - 3), 1.5f);
+            }
+            return score + 2.0f / std::sqrt(float(live));
+        }
+
+        void remap(const unsigned int* in, unsigned int nbTriangles) {
+            if(++m_currentStamp == 0) {
+                std::fill(m_stamp.begin(), m_stamp.end(), 0);
+                m_currentStamp = 1;
+            }
+            m_global.clear();
+            m_tri.resize(3 * nbTriangles);
+            for(unsigned int i = 0; i < 3 * nbTriangles; ++i) {
+                unsigned int v = in[i];
+                if(v >= m_stamp.size()) {
+                    m_stamp.resize(v + 1, 0);
+                    m_local.resize(v + 1);
+                }
+                if(m_stamp[v] != m_currentStamp) {
+                    m_stamp[v] = m_currentStamp;
+                    m_local[v] = m_global.size();
+                    m_global.push_back(v);
+                }
+                m_tri[i] = m_local[v];
+            }
+        }
+
+        void removeAdjacency(unsigned int v, unsigned int t) {
+            unsigned int begin = m_adjOffset[v];
+            unsigned int end = begin + m_live[v];
+            for(unsigned int a = begin; a < end; ++a) {
+                if(m_adj[a] == t) {
+                    std::swap(m_adj[a], m_adj[end - 1]);
+                    --m_live[v];
+                    return;
+                }
+            }
+        }
+};
+
+/*
+ * Flux de triangles ordonné pour le cache des sommets, tenu à jour à partir d'un
+ * PatchedIndexArray (FrontBuffers::triangles). Les triangles sont répartis dans les
+ * cellules d'une grille régulière (patchs) selon la position de leur premier sommet ;
+ * chaque patch est réordonné par ForsythOptimizer et occupe une plage fixe du flux,
+ * complétée par des triangles dégénérés. Seuls les patchs dont un triangle a changé
+ * sont réordonnés et transférés ; le flux n'est redisposé (avec de la marge) que si
+ * un patch déborde de sa plage.
+ * A mettre à jour avant que les places modifiées du tableau ne soient effacées.
+ */
+template <typename PFP>
+class CacheOrderedTriangles {
+    public:
+        CacheOrderedTriangles(unsigned int trianglesPerPatch = 512) :
+            m_trianglesPerPatch(trianglesPerPatch), m_resized(false), m_grid(0) {}
+
+        const std::vector<unsigned int>& indices() const { return m_indices; }
+        unsigned int nbPatches() const { return m_patches.size(); }
+
+        size_t memory() const {
+            size_t m = (m_indices.capacity() + m_slotPatch.capacity() + m_slotPos.capacity() + m_dirty.capacity()) * sizeof(unsigned int)
+                + m_patches.capacity() * sizeof(Patch);
+            for(unsigned int p = 0; p < m_patches.size(); ++p)
+                m += (m_patches[p].slots.capacity() + m_patches[p].order.capacity()) * sizeof(unsigned int);
+            return m;
+        }
+
+        //Flux recalculé entièrement au prochain update()
+        void reset() {
+            m_patches.clear();
+            m_slotPatch.clear();
+            m_slotPos.clear();
+            m_grid = 0;
+        }
+
+        void update(const PatchedIndexArray& triangles, const VertexAttribute<VEC3>& position) {
+            const std::vector<unsigned int>& indices = triangles.indices();
+            if(m_grid == 0) {
+                build(triangles, position);
+                return;
+            }
+
+            //Places disparues (tableau resserré), puis places modifiées
+            for(unsigned int s = triangles.nbSlots(); s < m_slotPatch.size(); ++s)
+                removeSlot(s);
+            if(m_slotPatch.size() > triangles.nbSlots()) {
+                m_slotPatch.resize(triangles.nbSlots());
+                m_slotPos.resize(triangles.nbSlots());
+            }
+            const std::vector<unsigned int>& dirty = triangles.dirtySlots();
+            for(unsigned int i = 0; i < dirty.size(); ++i) {
+                unsigned int s = dirty[i];
+                if(s >= triangles.nbSlots())
+                    continue;
+                removeSlot(s);
+                if(triangles.isUsed(s))
+                    addSlot(s, patchOf(position[indices[3 * s]]));
+            }
+
+            bool relayout = false;
+            for(unsigned int p = 0; p < m_patches.size(); ++p) {
+                if(!m_patches[p].dirty)
+                    continue;
+                optimizePatch(p, indices);
+                if(m_patches[p].order.size() > 3 * m_patches[p].capacity)
+                    relayout = true;
+            }
+            if(relayout) {
+                layout();
+                return;
+            }
+            for(unsigned int p = 0; p < m_patches.size(); ++p) {
+                if(m_patches[p].dirty) {
+                    writePatch(p);
+                    m_patches[p].dirty = false;
+                    m_dirty.push_back(p);
+                }
+            }
+        }
+
+        /*Plages modifiées depuis clearDirty(), même interface que PatchedIndexArray*/
+
+        bool resized() const { return m_resized; }
+        bool hasDirty() const { return !m_dirty.empty() || m_resized; }
+
+        void dirtyRanges(std::vector<std::pair<unsigned int, unsigned int> >& ranges, unsigned int maxGap = 64) {
+            ranges.clear();
+            std::sort(m_dirty.begin(), m_dirty.end());
+            for(unsigned int i = 0; i < m_dirty.size(); ++i) {
+                const Patch& patch = m_patches[m_dirty[i]];
+                if(patch.capacity == 0)
+                    continue;
+                unsigned int begin = 3 * patch.offset;
+                unsigned int end = 3 * (patch.offset + patch.capacity);
+                if(!ranges.empty() && begin <= ranges.back().second + 3 * maxGap)
+                    ranges.back().second = end;
+                else
+                    ranges.push_back(std::make_pair(begin, end));
+            }
+        }
+
+        void clearDirty() {
+            m_dirty.clear();
+            m_resized = false;
+        }
+
+    private:
+        struct Patch {
+            std::vector<unsigned int> slots;    //Places du tableau source
+            std::vector<unsigned int> order;    //Indices réordonnés
+            unsigned int offset;                //Plage du flux (en triangles)
+            unsigned int capacity;
+            bool dirty;
+            Patch() : offset(0), capacity(0), dirty(false) {}
+        };
+
+        unsigned int m_trianglesPerPatch;
+        std::vector<unsigned int> m_indices;
+        std::vector<Patch> m_patches;
+        std::vector<unsigned int> m_slotPatch;  //Place -> patch (NO_NODE si aucun)
+        std::vector<unsigned int> m_slotPos;    //Place -> position dans Patch::slots
+        std::vector<unsigned int> m_dirty;      //Patchs réécrits
+        bool m_resized;
+        ForsythOptimizer m_optimizer;
+        std::vector<unsigned int> m_gather;
+
+        /*Grille des patchs*/
+        unsigned int m_grid;    //Cellules par axe (0 : flux à construire)
+        VEC3 m_origin;
+        VEC3 m_cellSize;
+
+        //Grille choisie pour environ m_trianglesPerPatch triangles par cellule de la surface
+        void build(const PatchedIndexArray& triangles, const VertexAttribute<VEC3>& position) {
+            const std::vector<unsigned int>& indices = triangles.indices();
+            VEC3 bbMin(0.0f, 0.0f, 0.0f), bbMax(0.0f, 0.0f, 0.0f);
+            bool first = true;
+            for(unsigned int s = 0; s < triangles.nbSlots(); ++s) {
+                if(!triangles.isUsed(s))
+                    continue;
+                const VEC3& p = position[indices[3 * s]];
+                for(unsigned int k = 0; k < 3; ++k) {
+                    bbMin[k] = first ? p[k] : std::min(bbMin[k], p[k]);
+                    bbMax[k] = first ? p[k] : std::max(bbMax[k], p[k]);
+                }
+                first = false;
+            }
+            float cells = float(triangles.nbPrimitives()) / float(std::max(1u, m_trianglesPerPatch));
+            m_grid = std::max(1u, std::min(64u, (unsigned int)std::ceil(std::sqrt(cells))));
+            m_origin = bbMin;
+            for(unsigned int k = 0; k < 3; ++k)
+                m_cellSize[k] = std::max((bbMax[k] - bbMin[k]) / float(m_grid), 1e-6f);
+
+            m_patches.assign(m_grid * m_grid * m_grid, Patch());
+            m_slotPatch.assign(triangles.nbSlots(), NO_NODE);
+            m_slotPos.assign(triangles.nbSlots(), 0);
+            for(unsigned int s = 0; s < triangles.nbSlots(); ++s) {
+                if(triangles.isUsed(s))
+                    addSlot(s, patchOf(position[indices[3 * s]]));
+            }
+            for(unsigned int p = 0; p < m_patches.size(); ++p)
+                optimizePatch(p, indices);
+            layout();
+        }
+
+        unsigned int patchOf(const VEC3& p) const {
+            unsigned int c[3];
+            for(unsigned int k = 0; k < 3; ++k) {
+                float x = (p[k] - m_origin[k]) / m_cellSize[k];
+                c[k] = x <= 0.0f ? 0 : std::min(m_grid - 1, (unsigned int)x);
+            }
+            return (c[2] * m_grid + c[1]) * m_grid + c[0];
+        }
+
+        void addSlot(unsigned int s, unsigned int p) {
+            if(s >= m_slotPatch.size()) {
+                m_slotPatch.resize(s + 1, NO_NODE);
+                m_slotPos.resize(s + 1, 0);
+            }
+            Patch& patch = m_patches[p];
+            m_slotPatch[s] = p;
+            m_slotPos[s] = patch.slots.size();
+            patch.slots.push_back(s);
+            patch.dirty = true;
+        }
+
+        void removeSlot(unsigned int s) {
+            if(s >= m_slotPatch.size() || m_slotPatch[s] == NO_NODE)
+                return;
+            Patch& patch = m_patches[m_slotPatch[s]];
+            unsigned int last = patch.slots.back();
+            patch.slots[m_slotPos[s]] = last;
+            m_slotPos[last] = m_slotPos[s];
+            patch.slots.pop_back();
+            patch.dirty = true;
+            m_slotPatch[s] = NO_NODE;
+        }
+
+        void optimizePatch(unsigned int p, const std::vector<unsigned int>& indices) {
+            Patch& patch = m_patches[p];
+            m_gather.resize(3 * patch.slots.size());
+            for(unsigned int i = 0; i < patch.slots.size(); ++i)
+                std::copy(indices.begin() + 3 * patch.slots[i], indices.begin() + 3 * patch.slots[i] + 3, m_gather.begin() + 3 * i);
+            patch.order.clear();
+            if(!patch.slots.empty())
+                m_optimizer.optimize(&m_gather[0], patch.slots.size(), patch.order);
+        }
+
+        //Plage du patch : triangles réordonnés puis triangles dégénérés
+        void writePatch(unsigned int p) {
+            const Patch& patch = m_patches[p];
+            unsigned int begin = 3 * patch.offset;
+            std::copy(patch.order.begin(), patch.order.end(), m_indices.begin() + begin);
+            unsigned int pad = patch.order.empty() ? 0 : patch.order[0];
+            std::fill(m_indices.begin() + begin + patch.order.size(), m_indices.begin() + 3 * (patch.offset + patch.capacity), pad);
+        }
+
+        //Plages redisposées avec 25% de marge, flux entièrement réécrit
+        void layout() {
+            unsigned int offset = 0;
+            for(unsigned int p = 0; p < m_patches.size(); ++p) {
+                Patch& patch = m_patches[p];
+                unsigned int n = patch.order.size() / 3;
+                patch.offset = offset;
+                patch.capacity = n == 0 ? 0 : n + n / 4 + 1;
+                patch.dirty = false;
+                offset += patch.capacity;
+            }
+            m_indices.resize(3 * offset);
+            for(unsigned int p = 0; p < m_patches.size(); ++p)
+                writePatch(p);
+            m_dirty.clear();
+            for(unsigned int p = 0; p < m_patches.size(); ++p)
+                m_dirty.push_back(p);
+            m_resized = true;
+        }
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
@@ -0,0 +1,152 @@
+ #ifndef __VIEW_CRITERION_H__
+ #define __VIEW_CRITERION_H__
+
+#include <cmath>
+
+#include "Node.h"
+#include "NodeBounds.h"
+
+namespace CGoGN {
+
+namespace Algo {
+
+namespace Surface {
+
+namespace VDPMesh {
+
+/*
+ * Critère de raffinement dépendant du point de vue : un noeud actif est raffiné si
+ * sa sphère englobante est (au moins en partie) dans la pyramide de vue, si ses faces
+ * ne sont pas toutes vues de dos (cône des normales) et si son erreur géométrique,
+ * projetée à l'écran, dépasse la tolérance en pixels.
+ * Les trois tests sont conservatifs et monotones le long de la forêt (la sphère, le
+ * cône et l'erreur d'un parent contiennent ceux de ses fils) : un parent qui n'est pas
+ * à raffiner a des fils qui ne le sont pas non plus.
+ */
+class ViewCriterion {
+    public:
+        ViewCriterion() : m_eye(0.0f, 0.0f, 0.0f), m_pixelFactor(1.0f), m_perspective(true), m_tolerance(1.0f), m_backFaceCulling(true) {
+            for(unsigned int i = 0; i < 6; ++i)
+                m_planes[i][0] = m_planes[i][1] = m_planes[i][2] = m_planes[i][3] = 0.0f;
+        }
+
+        /*
+         * Caméra définie par les matrices OpenGL (stockage par colonnes) et la hauteur
+         * de la fenêtre en pixels
+         */
+        void setFromMatrices(const float* modelview, const float* projection, unsigned int viewportHeight) {
+            //Plans de la pyramide (Gribb-Hartmann) extraits de projection * modelview
+            float clip[16];
+            for(unsigned int col = 0; col < 4; ++col) {
+                for(unsigned int row = 0; row < 4; ++row) {
+                    float s = 0.0f;
+                    for(unsigned int k = 0; k < 4; ++k)
+                        s += projection[k * 4 + row] * modelview[col * 4 + k];
+                    clip[col * 4 + row] = s;
+                }
+            }
+            for(unsigned int p = 0; p < 6; ++p) {
+                unsigned int row = p / 2;
+                float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+                for(unsigned int col = 0; col < 4; ++col)
+                    m_planes[p][col] = clip[col * 4 + 3] + sign * clip[col * 4 + row];
+                float n = std::sqrt(m_planes[p][0] * m_planes[p][0] + m_planes[p][1] * m_planes[p][1] + m_planes[p][2] * m_planes[p][2]);
+                if(n > 0.0f) {
+                    for(unsigned int col = 0; col < 4; ++col)
+                        m_planes[p][col] /= n;
+                }
+            }
+
+            //Position de l'oeil : -R^T t
+            for(unsigned int i = 0; i < 3; ++i) {
+                m_eye[i] = 0.0f;
+                for(unsigned int k = 0; k < 3; ++k)
+                    m_eye[i] -= modelview[i * 4 + k] * modelview[12 + k];
+            }
+
+            //Pixels par unité de longueur à distance 1 (ou à toute distance en orthographique)
+            m_perspective = projection[11] != 0.0f;
+            m_pixelFactor = projection[5] * float(viewportHeight) * 0.5f;
+        }
+
+        /*Tolérance de l'erreur projetée, en pixels*/
+        float getTolerance() const { return m_tolerance; }
+        void setTolerance(float pixels) { m_tolerance = pixels; }
+
+        bool getBackFaceCulling() const { return m_backFaceCulling; }
+        void setBackFaceCulling(bool b) { m_backFaceCulling = b; }
+
+        const VEC3& getEye() const { return m_eye; }
+
+        //Faux si la sphère est entièrement hors de la pyramide de vue
+        bool isVisible(const BoundingSphere& s) const {
+            for(unsigned int p = 0; p < 6; ++p) {
+                const float* pl = m_planes[p];
+                if(pl[0] * s.center[0] + pl[1] * s.center[1] + pl[2] * s.center[2] + pl[3] < -s.radius)
+                    return false;
+            }
+            return true;
+        }
+
+        /*
+         * Vrai si toutes les faces du sous-arbre sont vues de dos depuis l'oeil : les
+         * directions de l'oeil vers la sphère restent à moins de beta = asin(r / d) de
+         * l'axe oeil-centre, les normales à moins de alpha de l'axe du cône, et il suffit
+         * que l'angle entre les deux axes soit inférieur à pi/2 - alpha - beta.
+         */
+        bool isBackFacing(const BoundingSphere& s, const NormalCone& cone) const {
+            if(!m_backFaceCulling || cone.isEmpty() || cone.isFull())
+                return false;
+            VEC3 v = s.center - m_eye;
+            float d = v.norm();
+            if(d <= s.radius)
+                return false;
+            float sinBeta = s.radius / d;
+            float cosBeta = std::sqrt(1.0f - sinBeta * sinBeta);
+            if(cone.angle + std::asin(sinBeta) >= HALF_PI)
+                return false;
+            //cos(theta) > sin(alpha + beta)
+            return cone.axis * v > d * (cone.sinAngle * cosBeta + cone.cosAngle * sinBeta);
+        }
+
+        //Erreur géométrique projetée à l'écran, en pixels (majorant)
+        float projectedError(const BoundingSphere& s, float error) const {
+            if(!m_perspective)
+                return error * m_pixelFactor;
+            float d = (s.center - m_eye).norm() - s.radius;
+            if(d <= 0.0f)
+                return error > 0.0f ? float(HUGE_VAL) : 0.0f;
+            return error * m_pixelFactor / d;
+        }
+
+        bool needsRefinement(const BoundingSphere& s, const NormalCone& cone, float error) const {
+            return projectedError(s, error) > m_tolerance && isVisible(s) && !isBackFacing(s, cone);
+        }
+
+        bool operator==(const ViewCriterion& v) const {
+            for(unsigned int p = 0; p < 6; ++p) {
+                for(unsigned int col = 0; col < 4; ++col) {
+                    if(m_planes[p][col] != v.m_planes[p][col])
+                        return false;
+                }
+            }
+            return m_eye == v.m_eye && m_pixelFactor == v.m_pixelFactor && m_perspective == v.m_perspective
+                && m_tolerance == v.m_tolerance && m_backFaceCulling == v.m_backFaceCulling;
+        }
+        bool operator!=(const ViewCriterion& v) const { return !(*this == v); }
+
+    private:
+        float m_planes[6][4];   //Gauche, droite, bas, haut, proche, lointain (normales intérieures)
+        VEC3 m_eye;
+        float m_pixelFactor;
+        bool m_perspective;
+        float m_tolerance;
+        bool m_backFaceCulling;
+};
+
+} //namespace VDPMesh
+} //namespace Surface
+} //namespace Algo
+} //namespace CGoGN
+
+#endif
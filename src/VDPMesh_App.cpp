@@ -51,7 +51,16 @@ VDPMesh_App::VDPMesh_App() :
 	m_pointSprite(NULL),
     m_strings(NULL),
     m_inactiveMarker(myMap),
-    m_pmesh(NULL)
+    m_pmesh(NULL),
+    m_refinementScheduled(false),
+    m_prefetchScheduled(false),
+    m_boxMoves(0),
+    m_restCheckMoves(0),
+    m_worker(NULL),
+    m_frontRender(NULL),
+    m_nodeNormals(false),
+    m_cacheOrder(false),
+    m_targetBox(NULL)
 {
 	normalScaleFactor = 1.0f ;
 	vertexScaleFactor = 0.1f ;
@@ -99,6 +108,22 @@ void VDPMesh_App::initGUI()
     setCallBack( dock.slider_vertexNumber, SIGNAL(valueChanged(int)), SLOT(slot_vertexNumber(int)));
     setCallBack( dock.pushButton_createPM, SIGNAL(clicked()), SLOT(slot_createPM()));
     setCallBack( dock.pushButton_update, SIGNAL(clicked()), SLOT(slot_update()));
+    setCallBack( dock.check_viewDependent, SIGNAL(toggled(bool)), SLOT(slot_viewDependent(bool)));
+    setCallBack( dock.check_graded, SIGNAL(toggled(bool)), SLOT(slot_graded(bool)));
+    setCallBack( dock.doubleSpinBox_tolerance, SIGNAL(valueChanged(double)), SLOT(slot_tolerance(double)));
+    setCallBack( dock.check_parallelUpdate, SIGNAL(toggled(bool)), SLOT(slot_parallelUpdate(bool)));
+    setCallBack( dock.check_asyncUpdate, SIGNAL(toggled(bool)), SLOT(slot_asyncUpdate(bool)));
+    setCallBack( dock.check_prefetch, SIGNAL(toggled(bool)), SLOT(slot_prefetchEnabled(bool)));
+    setCallBack( dock.check_nodeNormals, SIGNAL(toggled(bool)), SLOT(slot_nodeNormals(bool)));
+    setCallBack( dock.check_cacheOrder, SIGNAL(toggled(bool)), SLOT(slot_cacheOrder(bool)));
+    setCallBack( dock.check_profileCSV, SIGNAL(toggled(bool)), SLOT(slot_profileCSV(bool)));
+    setCallBack( dock.pushButton_profileReset, SIGNAL(clicked()), SLOT(slot_profileReset()));
+
+    if(!Profiler::enabled()) {
+        dock.check_profileCSV->setEnabled(false);
+        dock.pushButton_profileReset->setEnabled(false);
+        dock.text_profile->setPlainText("instrumentation disabled (build with VDPMESH_PROFILE)");
+    }
 }
 
 void VDPMesh_App::cb_initGL()
@@ -109,6 +134,7 @@ void VDPMesh_App::cb_initGL()
 
 	m_render = new Algo::Render::GL2::MapRender() ;
 	m_topoRender = new Algo::Render::GL2::TopoRender() ;
+	m_frontRender = new FrontRender() ;
 
 	m_topoRender->setInitialDartsColor(0.25f, 0.25f, 0.25f) ;
 
@@ -155,20 +181,23 @@ void VDPMesh_App::cb_initGL()
 
 void VDPMesh_App::cb_redraw()
 {
+	endProfileFrame();
+	updateView();
+
 	glClearColor(1.f,1.f,1.f,1.f);
 	if(m_drawVertices)
 	{
 		float size = vertexScaleFactor ;
 		m_pointSprite->setSize(size) ;
 		m_pointSprite->predraw(Geom::Vec3f(0.0f, 0.0f, 1.0f)) ;
-		m_render->draw(m_pointSprite, Algo::Render::GL2::POINTS) ;
+		drawPrimitives(m_pointSprite, Algo::Render::GL2::POINTS) ;
 		m_pointSprite->postdraw() ;
 	}
 
 	if(m_drawEdges)
 	{
 		glLineWidth(1.0f) ;
-		m_render->draw(m_simpleColorShader, Algo::Render::GL2::LINES) ;
+		drawPrimitives(m_simpleColorShader, Algo::Render::GL2::LINES) ;
 	}
 
 	if(m_drawFaces)
@@ -181,16 +210,17 @@ void VDPMesh_App::cb_redraw()
 		{
 			case FLAT :
 				m_flatShader->setExplode(faceShrinkage) ;
-				m_render->draw(m_flatShader, Algo::Render::GL2::TRIANGLES) ;
+				drawPrimitives(m_flatShader, Algo::Render::GL2::TRIANGLES) ;
 				break ;
 			case PHONG :
-				m_render->draw(m_phongShader, Algo::Render::GL2::TRIANGLES) ;
+				drawPrimitives(m_phongShader, Algo::Render::GL2::TRIANGLES) ;
 				break ;
 		}
 		glDisable(GL_POLYGON_OFFSET_FILL) ;
 	}
 
-	if(m_drawTopo)
+	//La topologie n'est pas recopiée par la mise à jour en tâche de fond
+	if(m_drawTopo && !m_worker)
 	{
 		m_topoRender->drawTopo() ;
 	}
@@ -200,15 +230,43 @@ void VDPMesh_App::cb_redraw()
 		float size = normalBaseSize * normalScaleFactor ;
 		m_vectorShader->setScale(size) ;
 		glLineWidth(1.0f) ;
-		m_render->draw(m_vectorShader, Algo::Render::GL2::POINTS) ;
+		drawPrimitives(m_vectorShader, Algo::Render::GL2::POINTS) ;
 	}
 
 	//m_strings->drawAll(Geom::Vec3f(0.0f, 1.0f, 1.0f));
 
-	if(m_pmesh && m_pmesh->getInterestBox()->getDrawer()) {
-		Utils::Drawer* drawer = m_pmesh->getInterestBox()->getDrawer();
+	Box* box = m_worker ? m_targetBox : (m_pmesh ? m_pmesh->getInterestBox() : NULL);
+	if(box && box->getDrawer()) {
+		Utils::Drawer* drawer = box->getDrawer();
 		drawer->callList();
 	}
+	for(unsigned int i = 0; i < m_pinnedRegions.size(); ++i)
+		m_pinnedRegions[i].second->getDrawer()->callList();
+}
+
+/*
+ * Affichage depuis la carte, ou depuis la dernière copie reçue du thread de mise à
+ * jour quand il tourne (la carte lui appartient alors)
+ */
+void VDPMesh_App::drawPrimitives(Utils::GLSLShader* sh, int prim)
+{
+	if(!m_worker && !(m_pmesh && m_pmesh->getChangeTracking()))
+	{
+		m_render->draw(sh, prim) ;
+		return ;
+	}
+	switch(prim)
+	{
+		case Algo::Render::GL2::POINTS :
+			m_frontRender->draw(sh, FrontRender::POINTS) ;
+			break ;
+		case Algo::Render::GL2::LINES :
+			m_frontRender->draw(sh, FrontRender::LINES) ;
+			break ;
+		default :
+			m_frontRender->draw(sh, FrontRender::TRIANGLES) ;
+			break ;
+	}
 }
 
 void VDPMesh_App::cb_Open()
@@ -250,55 +308,107 @@ void VDPMesh_App::storeVerticesInfo()
 void VDPMesh_App::cb_keyPress(int keycode)
 {
     if(m_pmesh) {
+		//Boîte éditée : celle du maillage, ou la cible transmise au thread de mise à jour
+		Box* box = m_worker ? m_targetBox : m_pmesh->getInterestBox();
+		//Seules les commandes qui touchent la carte ou les régions attendent la fin de la tranche
+		bool touchesMap = keycode == 'c' || keycode == 'a' || keycode == 'e';
+		QMutexLocker lock(m_worker && touchesMap ? &m_worker->mapMutex() : NULL);
+		VEC3 previousMin = box->getPosMin();
+		VEC3 previousMax = box->getPosMax();
 		switch(keycode)
 		{
 			case 'c' :
 				myMap.check();
 				break;
+			case 'a' :
+			{
+				//Epingle une copie de la boîte d'intérêt comme région supplémentaire
+				Box* pinned = new Box(box->getPosMin(), box->getPosMax());
+				pinned->updateDrawer();
+				unsigned int region = m_pmesh->addInterestBox(pinned->getPosMin(), pinned->getPosMax());
+				m_pinnedRegions.push_back(std::make_pair(region, pinned));
+				break;
+			}
+			case 'e' :
+				//Retire la dernière région épinglée
+				if(!m_pinnedRegions.empty()) {
+					m_pmesh->removeInterestRegion(m_pinnedRegions.back().first);
+					delete m_pinnedRegions.back().second;
+					m_pinnedRegions.pop_back();
+				}
+				break;
 			case 'd' :
-				m_pmesh->getInterestBox()->incPosMax((float)(bb.diag()[0]/10.), 0);
-				m_pmesh->getInterestBox()->incPosMin((float)(bb.diag()[0]/10.), 0);
+				box->incPosMax((float)(bb.diag()[0]/10.), 0);
+				box->incPosMin((float)(bb.diag()[0]/10.), 0);
 				break;
 			case 'q' :
-				m_pmesh->getInterestBox()->decPosMax((float)(bb.diag()[0]/10.), 0);
-				m_pmesh->getInterestBox()->decPosMin((float)(bb.diag()[0]/10.), 0);
+				box->decPosMax((float)(bb.diag()[0]/10.), 0);
+				box->decPosMin((float)(bb.diag()[0]/10.), 0);
 				break;
 			case 'z' :
-				m_pmesh->getInterestBox()->incPosMax((float)(bb.diag()[1]/10.), 1);
-				m_pmesh->getInterestBox()->incPosMin((float)(bb.diag()[1]/10.), 1);
+				box->incPosMax((float)(bb.diag()[1]/10.), 1);
+				box->incPosMin((float)(bb.diag()[1]/10.), 1);
 				break;
 			case 's' :
-				m_pmesh->getInterestBox()->decPosMax((float)(bb.diag()[1]/10.), 1);
-				m_pmesh->getInterestBox()->decPosMin((float)(bb.diag()[1]/10.), 1);
+				box->decPosMax((float)(bb.diag()[1]/10.), 1);
+				box->decPosMin((float)(bb.diag()[1]/10.), 1);
 				break;
 			case 'p' :
-				m_pmesh->getInterestBox()->incPosMax((float)(bb.diag()[0]/10.), 0);
-				m_pmesh->getInterestBox()->incPosMax((float)(bb.diag()[1]/10.), 1);
-				m_pmesh->getInterestBox()->incPosMax((float)(bb.diag()[2]/10.), 2);
-				m_pmesh->getInterestBox()->decPosMin((float)(bb.diag()[0]/10.), 0);
-				m_pmesh->getInterestBox()->decPosMin((float)(bb.diag()[1]/10.), 1);
-				m_pmesh->getInterestBox()->decPosMin((float)(bb.diag()[2]/10.), 2);
+				box->incPosMax((float)(bb.diag()[0]/10.), 0);
+				box->incPosMax((float)(bb.diag()[1]/10.), 1);
+				box->incPosMax((float)(bb.diag()[2]/10.), 2);
+				box->decPosMin((float)(bb.diag()[0]/10.), 0);
+				box->decPosMin((float)(bb.diag()[1]/10.), 1);
+				box->decPosMin((float)(bb.diag()[2]/10.), 2);
 				break;
 			case 'm' :
-				m_pmesh->getInterestBox()->decPosMax((float)(bb.diag()[0]/10.), 0);
-				m_pmesh->getInterestBox()->decPosMax((float)(bb.diag()[1]/10.), 1);
-				m_pmesh->getInterestBox()->decPosMax((float)(bb.diag()[2]/10.), 2);
-				m_pmesh->getInterestBox()->incPosMin((float)(bb.diag()[0]/10.), 0);
-				m_pmesh->getInterestBox()->incPosMin((float)(bb.diag()[1]/10.), 1);
-				m_pmesh->getInterestBox()->incPosMin((float)(bb.diag()[2]/10.), 2);
+				box->decPosMax((float)(bb.diag()[0]/10.), 0);
+				box->decPosMax((float)(bb.diag()[1]/10.), 1);
+				box->decPosMax((float)(bb.diag()[2]/10.), 2);
+				box->incPosMin((float)(bb.diag()[0]/10.), 0);
+				box->incPosMin((float)(bb.diag()[1]/10.), 1);
+				box->incPosMin((float)(bb.diag()[2]/10.), 2);
 				break;
 			default:
 				break;
 		}
-		m_pmesh->getInterestBox()->updateDrawer();
-		m_pmesh->updateRefinement();
-		updateMesh();
+		lock.unlock();
+		box->updateDrawer();
+		if(m_worker)
+			m_worker->setTarget(box->getPosMin(), box->getPosMax());
+		else {
+			if(box->getPosMin() != previousMin || box->getPosMax() != previousMax) {
+				//Un relevé par déplacement pour la prédiction du raffinement spéculatif
+				m_pmesh->recordInterestBox();
+				++m_boxMoves;
+			}
+			slot_continueRefinement();
+		}
 	}
 }
 
 void VDPMesh_App::importMesh(std::string& filename)
 {
+	if(m_worker)
+		dock.check_asyncUpdate->setChecked(false) ;
+
+	//Le maillage progressif (régions d'intérêt et raffinement spéculatif compris) et les
+	//régions épinglées se réfèrent à l'ancienne carte : libérés avant qu'elle ne soit
+	//vidée, les VSplit rendant leurs lignes d'attributs. Sans maillage progressif,
+	//l'interface peut ne pas exister encore (import en ligne de commande)
+	for(unsigned int i = 0; i < m_pinnedRegions.size(); ++i)
+		delete m_pinnedRegions[i].second ;
+	m_pinnedRegions.clear() ;
+	if(m_pmesh)
+	{
+		delete m_pmesh ;
+		m_pmesh = NULL ;
+		m_inactiveMarker.unmarkAll() ;
+		dock.slider_vertexNumber->setEnabled(false) ;
+	}
+
 	myMap.clear(true) ;
+	m_meshFile = filename ;
 
 	size_t pos = filename.rfind(".");    // position of "." in filename
 	std::string extension = filename.substr(pos);
@@ -338,6 +448,7 @@ void VDPMesh_App::exportMesh(std::string& filename, bool askExportMode)
 {
 	size_t pos = filename.rfind(".") ;    // position of "." in filename
 	std::string extension = filename.substr(pos) ;
+	QMutexLocker lock(m_worker ? &m_worker->mapMutex() : NULL) ;
 
 	if (extension == std::string(".off"))
 		Algo::Surface::Export::exportOFF<PFP>(myMap, position, filename.c_str(), allDarts) ;
@@ -357,17 +468,81 @@ void VDPMesh_App::exportMesh(std::string& filename, bool askExportMode)
 		std::cerr << "Cannot save file " << filename << " : unknown or unhandled extension" << std::endl ;
 }
 
+/*
+ * Avec le suivi des changements du maillage progressif, seules les primitives et les
+ * normales autour des transformations faites depuis la mise à jour précédente sont
+ * revues et transférées (les positions ne changent qu'à la reconstruction) ; sinon,
+ * les primitives et les normales sont reconstruites depuis toute la carte.
+ */
 void VDPMesh_App::updateMesh() {
-	m_render->initPrimitives<PFP>(myMap, *m_selectorMarked, Algo::Render::GL2::POINTS) ;
-	m_render->initPrimitives<PFP>(myMap, *m_selectorMarked, Algo::Render::GL2::LINES) ;
-	m_render->initPrimitives<PFP>(myMap, *m_selectorMarked, Algo::Render::GL2::TRIANGLES) ;
+	VDPM_TIMER(PHASE_UPDATE_MESH) ;
+	if(m_pmesh && m_pmesh->getChangeTracking())
+	{
+		FrontChanges& changes = m_pmesh->getChanges() ;
+		bool rebuild = changes.rebuild ;
+		bool nodeNormals = m_nodeNormals && m_pmesh->getNodeNormals().size() == m_pmesh->getNodes().size() ;
+		{
+			VDPM_TIMER(PHASE_MESH_NORMALS) ;
+			//Les normales sont revues avant que apply() n'efface les changements
+			if(rebuild && nodeNormals)
+				m_frontNormals.assign(m_pmesh->getNodes(), m_pmesh->getNodeNormals(), normal) ;
+			else if(rebuild)
+				Algo::Surface::Geometry::computeNormalVertices<PFP>(myMap, position, normal) ;
+			else if(nodeNormals)
+				m_frontNormals.update(m_pmesh->getNodes(), m_pmesh->getNodeNormals(), normal, changes) ;
+			else
+				m_frontNormals.update(myMap, m_inactiveMarker, position, normal, changes) ;
+		}
+		{
+			VDPM_TIMER(PHASE_MESH_BUFFERS) ;
+			m_frontBuffers.apply(myMap, m_inactiveMarker, m_pmesh->getNodes(), changes) ;
+			if(m_cacheOrder)
+			{
+				//Le flux ordonné relit les places modifiées avant qu'elles ne soient effacées
+				if(rebuild)
+					m_orderedTriangles.reset() ;
+				m_orderedTriangles.update(m_frontBuffers.triangles, position) ;
+				if(rebuild)
+					CGoGNout << "ACMR : " << acmr(m_frontBuffers.triangles.indices()) << " -> "
+					         << acmr(m_orderedTriangles.indices()) << " (" << m_orderedTriangles.nbPatches() << " patchs)" << CGoGNendl ;
+			}
+		}
+		{
+			VDPM_TIMER(PHASE_MESH_UPLOAD) ;
+			m_frontRender->patch(m_frontBuffers, m_cacheOrder ? &m_orderedTriangles : NULL) ;
+			if(rebuild)
+			{
+				m_positionVBO->updateData(position) ;
+				m_normalVBO->updateData(normal) ;
+			}
+			else
+				m_frontRender->patchNormals(m_normalVBO, normal, m_frontNormals.touched()) ;
+		}
+		if(m_drawTopo)
+			m_topoRender->updateData<PFP>(myMap, position, 0.85f, 0.85f, *m_selectorMarked) ;
+		updateGL() ;
+		return ;
+	}
+
+	{
+		VDPM_TIMER(PHASE_MESH_BUFFERS) ;
+		m_render->initPrimitives<PFP>(myMap, *m_selectorMarked, Algo::Render::GL2::POINTS) ;
+		m_render->initPrimitives<PFP>(myMap, *m_selectorMarked, Algo::Render::GL2::LINES) ;
+		m_render->initPrimitives<PFP>(myMap, *m_selectorMarked, Algo::Render::GL2::TRIANGLES) ;
+	}
 	
     m_topoRender->updateData<PFP>(myMap, position, 0.85f, 0.85f, *m_selectorMarked) ;
 	
-    Algo::Surface::Geometry::computeNormalVertices<PFP>(myMap, position, normal) ;
+	{
+		VDPM_TIMER(PHASE_MESH_NORMALS) ;
+		Algo::Surface::Geometry::computeNormalVertices<PFP>(myMap, position, normal) ;
+	}
 	
-    m_positionVBO->updateData(position) ;
-	m_normalVBO->updateData(normal) ;
+	{
+		VDPM_TIMER(PHASE_MESH_UPLOAD) ;
+		m_positionVBO->updateData(position) ;
+		m_normalVBO->updateData(normal) ;
+	}
 
 	storeVerticesInfo();
 	m_strings->sendToVBO();
@@ -409,6 +584,9 @@ void VDPMesh_App::slot_faceLighting(int i)
 void VDPMesh_App::slot_drawTopo(bool b)
 {
 	m_drawTopo = b ;
+	//La topologie n'est tenue à jour que lorsqu'elle est affichée
+	if(b && !m_worker && m_pmesh && m_pmesh->getChangeTracking())
+		m_topoRender->updateData<PFP>(myMap, position, 0.85f, 0.85f, *m_selectorMarked) ;
 	updateGL() ;
 }
 
@@ -421,6 +599,7 @@ void VDPMesh_App::slot_drawNormals(bool b)
 void VDPMesh_App::slot_normalsSize(int i)
 {
 	normalScaleFactor = i / 50.0f ;
+	QMutexLocker lock(m_worker ? &m_worker->mapMutex() : NULL) ;
 	m_topoRender->updateData<PFP>(myMap, position, i / 100.0f, i / 100.0f) ;
 	updateGL() ;
 }
@@ -435,21 +614,309 @@ void VDPMesh_App::slot_vertexNumber(int i)
 }
 
 void VDPMesh_App::slot_createPM() {
-    m_pmesh = new VDProgressiveMesh<PFP>(myMap, m_inactiveMarker, position, bb);
-
-    m_pmesh->createPM(dock.lineEdit_pourcent->text().toInt());
+    /*La reconstruction n'a pas lieu pendant une mise à jour en tâche de fond*/
+    bool async = m_worker != NULL;
+    if(async)
+        dock.check_asyncUpdate->setChecked(false);
+
+    /*Une hiérarchie existante du même maillage est reconstruite en réutilisant le même
+      VDProgressiveMesh (importMesh le libère à chaque nouveau maillage)*/
+    if(!m_pmesh) {
+        m_pmesh = new VDProgressiveMesh<PFP>(myMap, m_inactiveMarker, position, bb);
+        m_pmesh->getInterestBox()->updateDrawer();
+        m_pmesh->setChangeTracking(true);
+    }
+    m_pmesh->setBuildMode(dock.check_parallelBuild->isChecked() ? BUILD_PARALLEL : BUILD_SERIAL);
+    m_pmesh->setCollapseOrdering(dock.check_lazyQueue->isChecked() ? ORDER_LAZY_QUEUE : ORDER_SELECTOR);
+    m_pmesh->setBalanceWeight(float(dock.doubleSpinBox_balance->value()));
+    //Raffinement gradué : tolérance de 2% de la distance, jusqu'à la taille du modèle
+    m_pmesh->setGradedFalloff(LinearFalloff(0.0f, 0.02f, bb.maxSize()));
+    m_pmesh->setPrefetchLookAhead(dock.check_prefetch->isChecked() ? PREFETCH_LOOKAHEAD : 0.0f);
+    applyCriterion();
+
+    /*La hiérarchie est rechargée depuis le cache si elle a déjà été construite avec ces paramètres*/
+    unsigned int percent = dock.lineEdit_pourcent->text().toInt();
+    std::string cacheFile = m_meshFile + ".vdpm";
+    unsigned long long key = m_pmesh->hierarchyKey(hashFile(m_meshFile), percent);
+    if(m_meshFile.empty() || !m_pmesh->loadHierarchy(cacheFile, key)) {
+        m_pmesh->createPM(percent);
+        if(!m_meshFile.empty() && !m_pmesh->saveHierarchy(cacheFile, key))
+            CGoGNerr << "could not write hierarchy cache " << cacheFile << CGoGNendl;
+    }
+    else {
+        normal = myMap.getAttribute<VEC3, VERTEX>("normal") ;
+        if(!normal.isValid())
+            normal = myMap.addAttribute<VEC3, VERTEX>("normal") ;
+    }
 
     dock.slider_vertexNumber->setEnabled(true);
     dock.slider_vertexNumber->setSliderPosition(100);
-    dock.pushButton_createPM->setEnabled(false);
-    dock.lineEdit_pourcent->setEnabled(false);
 	
     updateMesh();
+    if(async)
+        dock.check_asyncUpdate->setChecked(true);
 }
 
 void VDPMesh_App::slot_update() {
-   m_pmesh->updateRefinement();
-   updateMesh();
+   slot_continueRefinement();
+}
+
+/*
+ * Une tranche de mise à jour du raffinement par passage dans la boucle Qt : la
+ * latence d'une image reste bornée quelle que soit l'ampleur du changement, la
+ * suite étant reprise au passage suivant jusqu'à convergence.
+ * En mise à jour parallèle, le front converge en un seul passage.
+ */
+const double VDPMesh_App::REFINEMENT_SLICE = 0.02;
+
+void VDPMesh_App::slot_continueRefinement() {
+    m_refinementScheduled = false;
+    if(!m_pmesh)
+        return;
+    if(m_worker) {
+        m_worker->wake();
+        return;
+    }
+    bool converged = true;
+    if(dock.check_parallelUpdate->isChecked())
+        m_pmesh->updateRefinementParallel();
+    else
+        converged = m_pmesh->updateRefinement(RefinementBudget(0, REFINEMENT_SLICE));
+    updateMesh();
+    if(!converged)
+        scheduleRefinement();
+    else
+        schedulePrefetch();
+}
+
+/*
+ * Raffinement spéculatif devant la boîte, par tranches, quand la boucle Qt est
+ * inoccupée depuis PREFETCH_DELAY ms ; toute mise à jour programmée passe avant
+ */
+const int VDPMesh_App::PREFETCH_DELAY = 50;
+const float VDPMesh_App::PREFETCH_LOOKAHEAD = 2.0f;
+
+void VDPMesh_App::schedulePrefetch() {
+    if(m_prefetchScheduled || !m_pmesh || m_pmesh->getPrefetchLookAhead() <= 0.0f)
+        return;
+    m_prefetchScheduled = true;
+    QTimer::singleShot(PREFETCH_DELAY, this, SLOT(slot_prefetch()));
+}
+
+void VDPMesh_App::slot_prefetch() {
+    m_prefetchScheduled = false;
+    if(!m_pmesh || m_worker || m_refinementScheduled)
+        return;
+    bool converged = m_pmesh->updatePrefetch(RefinementBudget(0, REFINEMENT_SLICE));
+    updateMesh();
+    if(!converged)
+        schedulePrefetch();
+    else if(m_pmesh->isPrefetching()) {
+        //Zone anticipée en place : défaite si la boîte ne bouge plus d'ici REST_DELAY
+        m_restCheckMoves = m_boxMoves;
+        QTimer::singleShot(BoxPredictor::REST_DELAY, this, SLOT(slot_boxAtRest()));
+    }
+}
+
+void VDPMesh_App::slot_boxAtRest() {
+    if(!m_pmesh || m_worker || m_boxMoves != m_restCheckMoves)
+        return;
+    //Déplacement nul : la prédiction échoue au prochain passage
+    m_pmesh->recordInterestBox();
+    schedulePrefetch();
+}
+
+void VDPMesh_App::slot_prefetchEnabled(bool b) {
+    if(!m_pmesh)
+        return;
+    {
+        QMutexLocker lock(m_worker ? &m_worker->mapMutex() : NULL);
+        m_pmesh->setPrefetchLookAhead(b ? PREFETCH_LOOKAHEAD : 0.0f);
+    }
+    scheduleRefinement();
+}
+
+/*
+ * Normales précalculées des noeuds (reprises telles quelles) ou recalculées autour
+ * des changements ; le changement de mode recalcule toutes les normales
+ */
+void VDPMesh_App::slot_nodeNormals(bool b) {
+    m_nodeNormals = b;
+    if(!m_pmesh || m_worker || !m_pmesh->getChangeTracking())
+        return;
+    m_pmesh->getChanges().requestRebuild();
+    updateMesh();
+}
+
+/*
+ * Triangles émis dans l'ordre optimisé pour le cache des sommets (par patchs) ou dans
+ * l'ordre des places du tableau tenu à jour ; le changement d'ordre retransfère tout
+ */
+void VDPMesh_App::slot_cacheOrder(bool b) {
+    m_cacheOrder = b;
+    m_orderedTriangles.reset();
+    if(!m_pmesh || m_worker || !m_pmesh->getChangeTracking())
+        return;
+    m_pmesh->getChanges().requestRebuild();
+    updateMesh();
+}
+
+/*
+ * Transmet le point de vue courant au critère de vue ; une mise à jour du
+ * raffinement est programmée si la caméra a bougé
+ */
+void VDPMesh_App::updateView() {
+    if(!m_pmesh || m_pmesh->getRefinementCriterion() != CRITERION_VIEW)
+        return;
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    ViewCriterion view = m_pmesh->getView();
+    view.setFromMatrices(glm::value_ptr(modelViewMatrix()), glm::value_ptr(projectionMatrix()), viewport[3]);
+    view.setTolerance(float(dock.doubleSpinBox_tolerance->value()));
+    if(view != m_pmesh->getView()) {
+        {
+            QMutexLocker lock(m_worker ? &m_worker->mapMutex() : NULL);
+            m_pmesh->setView(view);
+        }
+        scheduleRefinement();
+    }
+}
+
+void VDPMesh_App::applyCriterion() {
+    if(!m_pmesh)
+        return;
+    {
+        QMutexLocker lock(m_worker ? &m_worker->mapMutex() : NULL);
+        if(dock.check_graded->isChecked())
+            m_pmesh->setRefinementCriterion(CRITERION_GRADED);
+        else if(dock.check_viewDependent->isChecked())
+            m_pmesh->setRefinementCriterion(CRITERION_VIEW);
+        else
+            m_pmesh->setRefinementCriterion(CRITERION_BOX);
+    }
+    updateView();
+}
+
+void VDPMesh_App::slot_viewDependent(bool) {
+    applyCriterion();
+    scheduleRefinement();
+}
+
+void VDPMesh_App::slot_graded(bool) {
+    applyCriterion();
+    scheduleRefinement();
+}
+
+void VDPMesh_App::slot_tolerance(double) {
+    updateGL();
+}
+
+void VDPMesh_App::scheduleRefinement() {
+    if(m_worker) {
+        m_worker->wake();
+        return;
+    }
+    if(m_refinementScheduled)
+        return;
+    m_refinementScheduled = true;
+    QTimer::singleShot(0, this, SLOT(slot_continueRefinement()));
+}
+
+void VDPMesh_App::slot_parallelUpdate(bool b) {
+    if(m_worker)
+        m_worker->setParallel(b);
+}
+
+void VDPMesh_App::slot_asyncUpdate(bool b) {
+    if(b)
+        startWorker();
+    else
+        stopWorker();
+    updateGL();
+}
+
+/*
+ * Mise à jour en tâche de fond : la boîte éditée au clavier devient une cible
+ * transmise au thread, qui possède la carte jusqu'à son arrêt
+ */
+void VDPMesh_App::startWorker() {
+    if(m_worker || !m_pmesh)
+        return;
+    m_targetBox = new Box(m_pmesh->getInterestBox()->getPosMin(), m_pmesh->getInterestBox()->getPosMax());
+    m_targetBox->updateDrawer();
+    m_positionVBO->updateData(position);
+    //Les changements sont lus par le thread pendant la mise à jour en tâche de fond
+    m_worker = new RefinementWorker<PFP>(*m_pmesh, myMap, m_inactiveMarker, position, normal,
+                                         this, "slot_snapshotReady", REFINEMENT_SLICE);
+    m_worker->setParallel(dock.check_parallelUpdate->isChecked());
+    m_worker->start();
+}
+
+void VDPMesh_App::stopWorker() {
+    if(!m_worker)
+        return;
+    delete m_worker;
+    m_worker = NULL;
+    //Dernière cible éventuellement pas encore appliquée
+    m_pmesh->getInterestBox()->setPosMin(m_targetBox->getPosMin());
+    m_pmesh->getInterestBox()->setPosMax(m_targetBox->getPosMax());
+    m_pmesh->getInterestBox()->updateDrawer();
+    delete m_targetBox;
+    m_targetBox = NULL;
+    //Les changements lus par le thread manquent aux primitives de l'application
+    m_pmesh->setChangeTracking(true);
+    slot_continueRefinement();
+}
+
+/*
+ * Prise en compte de la dernière copie publiée par le thread de mise à jour
+ */
+void VDPMesh_App::slot_snapshotReady() {
+    if(!m_worker)
+        return;
+    const FrontSnapshot& snapshot = m_worker->lockSnapshot();
+    m_frontRender->upload(snapshot, m_normalVBO);
+    m_worker->unlockSnapshot();
+    updateGL();
+}
+
+/*
+ * Clôt la trame de l'instrumentation : le travail fait depuis l'affichage précédent
+ * (mises à jour du raffinement et du maillage) est affiché dans le panneau s'il y en
+ * a eu, et écrit dans le fichier CSV s'il est ouvert
+ */
+void VDPMesh_App::endProfileFrame() {
+    if(!Profiler::enabled())
+        return;
+    Profiler& profiler = Profiler::instance();
+    profiler.endFrame();
+    if(m_profileCSV.is_open())
+        profiler.writeCSVRow(m_profileCSV);
+    if(profiler.frameActive()) {
+        std::ostringstream report;
+        report << "frame " << profiler.nbFrames() << " (cumul)\n";
+        profiler.writeReport(report);
+        dock.text_profile->setPlainText(QString::fromStdString(report.str()));
+    }
+}
+
+void VDPMesh_App::slot_profileCSV(bool b) {
+    if(m_profileCSV.is_open())
+        m_profileCSV.close();
+    if(!b)
+        return;
+    m_profileCSV.open("vdpm_profile.csv");
+    if(!m_profileCSV) {
+        CGoGNerr << "could not open vdpm_profile.csv" << CGoGNendl;
+        dock.check_profileCSV->setChecked(false);
+        return;
+    }
+    Profiler::writeCSVHeader(m_profileCSV);
+}
+
+void VDPMesh_App::slot_profileReset() {
+    Profiler::instance().reset();
+    dock.text_profile->clear();
 }
 
 } // namespace VDPMesh
@@ -463,6 +930,17 @@ void VDPMesh_App::slot_update() {
 
 int main(int argc, char **argv)
 {
+	/*Construction hors mémoire : VDPMesh_App --stream input.off workDir budgetMB [pourcentage].
+	  workDir/top.off s'ouvre ensuite comme tout maillage : sa hiérarchie (niveaux
+	  supérieurs, file paresseuse, même pourcentage) est rechargée depuis top.off.vdpm*/
+	if(argc >= 5 && std::string(argv[1]) == "--stream")
+	{
+		CGoGN::Algo::Surface::VDPMesh::StreamingPMBuilder<CGoGN::Algo::Surface::VDPMesh::PFP> builder(argv[3], size_t(atol(argv[4])) * 1024 * 1024) ;
+		if(argc >= 6)
+			builder.setPercentWantedVertices(atoi(argv[5])) ;
+		return builder.build(argv[2]) ? 0 : 1 ;
+	}
+
 	QApplication app(argc, argv) ;
 
     CGoGN::Algo::Surface::VDPMesh::VDPMesh_App sqt ;